@@ -40,59 +40,85 @@ class ZenohDartBindings {
 
   set session_opened(bool value) => _session_opened.value = value;
 
-  /// Global variables for zenoh_get reply handling
-  late final ffi.Pointer<ffi.Bool> _reply_received =
-      _lookup<ffi.Bool>('reply_received');
+  /// Sample keys interned for the string callback
+  late final ffi.Pointer<key_table_t> _g_key_table =
+      _lookup<key_table_t>('g_key_table');
 
-  bool get reply_received => _reply_received.value;
+  key_table_t get g_key_table => _g_key_table.ref;
 
-  set reply_received(bool value) => _reply_received.value = value;
+  /// Key expressions declared for hot put and get keys
+  late final ffi.Pointer<keyexpr_cache_t> _g_keyexpr_cache =
+      _lookup<keyexpr_cache_t>('g_keyexpr_cache');
 
-  late final ffi.Pointer<ffi.Pointer<ffi.Char>> _last_received_value =
-      _lookup<ffi.Pointer<ffi.Char>>('last_received_value');
+  keyexpr_cache_t get g_keyexpr_cache => _g_keyexpr_cache.ref;
 
-  ffi.Pointer<ffi.Char> get last_received_value => _last_received_value.value;
+  /// Callback buffers handed to Dart, returned with zenoh_release()
+  late final ffi.Pointer<ffi.Array<slab_class_t>> _g_slabs =
+      _lookup<ffi.Array<slab_class_t>>('g_slabs');
 
-  set last_received_value(ffi.Pointer<ffi.Char> value) =>
-      _last_received_value.value = value;
+  ffi.Array<slab_class_t> get g_slabs => _g_slabs.ref;
 
-  /// Global variables for zenoh_put publisher handling
-  late final ffi.Pointer<z_owned_publisher_t> _global_publisher =
-      _lookup<z_owned_publisher_t>('global_publisher');
+  /// Buffers handed to zenoh by z_bytes_from_buf() come back here
+  late final ffi.Pointer<publish_pool_t> _g_publish_pool =
+      _lookup<publish_pool_t>('g_publish_pool');
 
-  z_owned_publisher_t get global_publisher => _global_publisher.ref;
+  publish_pool_t get g_publish_pool => _g_publish_pool.ref;
 
-  late final ffi.Pointer<ffi.Bool> _publisher_declared =
-      _lookup<ffi.Bool>('publisher_declared');
+  /// Declared publishers, the handle is the slot index
+  late final ffi.Pointer<ffi.Pointer<publisher_t>> _g_publishers =
+      _lookup<ffi.Pointer<publisher_t>>('g_publishers');
 
-  bool get publisher_declared => _publisher_declared.value;
+  ffi.Pointer<publisher_t> get g_publishers => _g_publishers.value;
 
-  set publisher_declared(bool value) => _publisher_declared.value = value;
+  set g_publishers(ffi.Pointer<publisher_t> value) =>
+      _g_publishers.value = value;
 
-  late final ffi.Pointer<ffi.Pointer<ffi.Char>> _current_publisher_key =
-      _lookup<ffi.Pointer<ffi.Char>>('current_publisher_key');
+  /// Guards g_publishers, a slot is claimed while its key_expr is set
+  late final ffi.Pointer<z_owned_mutex_t> _g_publishers_mutex =
+      _lookup<z_owned_mutex_t>('g_publishers_mutex');
 
-  ffi.Pointer<ffi.Char> get current_publisher_key =>
-      _current_publisher_key.value;
+  z_owned_mutex_t get g_publishers_mutex => _g_publishers_mutex.ref;
 
-  set current_publisher_key(ffi.Pointer<ffi.Char> value) =>
-      _current_publisher_key.value = value;
+  /// Publishers behind zenoh_publish()
+  late final ffi.Pointer<publish_cache_t> _g_publish_cache =
+      _lookup<publish_cache_t>('g_publish_cache');
 
-  /// Multiple subscribers support
-  late final ffi.Pointer<ffi.Pointer<subscriber_t>> _g_subscribers =
-      _lookup<ffi.Pointer<subscriber_t>>('g_subscribers');
+  publish_cache_t get g_publish_cache => _g_publish_cache.ref;
+
+  /// Declared queriers, the handle is the slot index
+  late final ffi.Pointer<ffi.Pointer<querier_t>> _g_queriers =
+      _lookup<ffi.Pointer<querier_t>>('g_queriers');
+
+  ffi.Pointer<querier_t> get g_queriers => _g_queriers.value;
+
+  set g_queriers(ffi.Pointer<querier_t> value) => _g_queriers.value = value;
+
+  /// Guards g_queriers, a slot is claimed while its key_expr is set
+  late final ffi.Pointer<z_owned_mutex_t> _g_queriers_mutex =
+      _lookup<z_owned_mutex_t>('g_queriers_mutex');
+
+  z_owned_mutex_t get g_queriers_mutex => _g_queriers_mutex.ref;
+
+  /// Declared queryables, the handle is the slot index
+  late final ffi.Pointer<ffi.Pointer<queryable_t>> _g_queryables =
+      _lookup<ffi.Pointer<queryable_t>>('g_queryables');
+
+  ffi.Pointer<queryable_t> get g_queryables => _g_queryables.value;
 
-  ffi.Pointer<subscriber_t> get g_subscribers => _g_subscribers.value;
+  set g_queryables(ffi.Pointer<queryable_t> value) =>
+      _g_queryables.value = value;
 
-  set g_subscribers(ffi.Pointer<subscriber_t> value) =>
-      _g_subscribers.value = value;
+  /// Guards g_queryables, a slot is claimed while its key_expr is set
+  late final ffi.Pointer<z_owned_mutex_t> _g_queryables_mutex =
+      _lookup<z_owned_mutex_t>('g_queryables_mutex');
 
-  late final ffi.Pointer<ffi.Int> _g_next_subscriber_id =
-      _lookup<ffi.Int>('g_next_subscriber_id');
+  z_owned_mutex_t get g_queryables_mutex => _g_queryables_mutex.ref;
 
-  int get g_next_subscriber_id => _g_next_subscriber_id.value;
+  /// Multiple subscribers support
+  late final ffi.Pointer<subscriber_table_t> _g_subscribers =
+      _lookup<subscriber_table_t>('g_subscribers');
 
-  set g_next_subscriber_id(int value) => _g_next_subscriber_id.value = value;
+  subscriber_table_t get g_subscribers => _g_subscribers.ref;
 
   /// Function declarations
   int zenoh_init() {
@@ -137,6 +163,24 @@ class ZenohDartBindings {
   late final _zenoh_close_session =
       _zenoh_close_sessionPtr.asFunction<void Function()>();
 
+  void zenoh_keyexpr_cache_stats(
+    ffi.Pointer<ffi.Uint64> hits,
+    ffi.Pointer<ffi.Uint64> misses,
+  ) {
+    return _zenoh_keyexpr_cache_stats(
+      hits,
+      misses,
+    );
+  }
+
+  late final _zenoh_keyexpr_cache_statsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Void Function(ffi.Pointer<ffi.Uint64>,
+              ffi.Pointer<ffi.Uint64>)>>('zenoh_keyexpr_cache_stats');
+  late final _zenoh_keyexpr_cache_stats =
+      _zenoh_keyexpr_cache_statsPtr.asFunction<
+          void Function(ffi.Pointer<ffi.Uint64>, ffi.Pointer<ffi.Uint64>)>();
+
   int zenoh_put(
     ffi.Pointer<ffi.Char> key,
     ffi.Pointer<ffi.Char> value,
@@ -154,6 +198,57 @@ class ZenohDartBindings {
   late final _zenoh_put = _zenoh_putPtr
       .asFunction<int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
 
+  int zenoh_put_with_options(
+    ffi.Pointer<ffi.Char> key,
+    ffi.Pointer<ffi.Char> value,
+    ffi.Pointer<publisher_options_t> options,
+  ) {
+    return _zenoh_put_with_options(
+      key,
+      value,
+      options,
+    );
+  }
+
+  late final _zenoh_put_with_optionsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>,
+              ffi.Pointer<publisher_options_t>)>>('zenoh_put_with_options');
+  late final _zenoh_put_with_options = _zenoh_put_with_optionsPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>,
+          ffi.Pointer<publisher_options_t>)>();
+
+  int zenoh_put_bytes(
+    ffi.Pointer<ffi.Char> key,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
+    ffi.Pointer<publisher_options_t> options,
+  ) {
+    return _zenoh_put_bytes(
+      key,
+      data,
+      len,
+      attachment,
+      attachment_len,
+      options,
+    );
+  }
+
+  late final _zenoh_put_bytesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Pointer<publisher_options_t>)>>('zenoh_put_bytes');
+  late final _zenoh_put_bytes = _zenoh_put_bytesPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Uint8>, int,
+          ffi.Pointer<ffi.Uint8>, int, ffi.Pointer<publisher_options_t>)>();
+
   int zenoh_publish(
     ffi.Pointer<ffi.Char> key,
     ffi.Pointer<ffi.Char> value,
@@ -171,6 +266,187 @@ class ZenohDartBindings {
   late final _zenoh_publish = _zenoh_publishPtr
       .asFunction<int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>)>();
 
+  int zenoh_declare_publisher(
+    ffi.Pointer<ffi.Char> key_expr,
+    ffi.Pointer<publisher_options_t> options,
+  ) {
+    return _zenoh_declare_publisher(
+      key_expr,
+      options,
+    );
+  }
+
+  late final _zenoh_declare_publisherPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>,
+              ffi.Pointer<publisher_options_t>)>>('zenoh_declare_publisher');
+  late final _zenoh_declare_publisher = _zenoh_declare_publisherPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<publisher_options_t>)>();
+
+  int zenoh_publisher_put(
+    int handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
+  ) {
+    return _zenoh_publisher_put(
+      handle,
+      data,
+      len,
+      attachment,
+      attachment_len,
+    );
+  }
+
+  late final _zenoh_publisher_putPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Int, ffi.Pointer<ffi.Uint8>, ffi.Size,
+              ffi.Pointer<ffi.Uint8>, ffi.Size)>>('zenoh_publisher_put');
+  late final _zenoh_publisher_put = _zenoh_publisher_putPtr.asFunction<
+      int Function(int, ffi.Pointer<ffi.Uint8>, int, ffi.Pointer<ffi.Uint8>,
+          int)>();
+
+  int zenoh_publish_batch(
+    int handle,
+    ffi.Pointer<ffi.Uint8> buf,
+    ffi.Pointer<ffi.Uint32> offsets,
+    int count,
+  ) {
+    return _zenoh_publish_batch(
+      handle,
+      buf,
+      offsets,
+      count,
+    );
+  }
+
+  late final _zenoh_publish_batchPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Int, ffi.Pointer<ffi.Uint8>,
+              ffi.Pointer<ffi.Uint32>, ffi.Size)>>('zenoh_publish_batch');
+  late final _zenoh_publish_batch = _zenoh_publish_batchPtr.asFunction<
+      int Function(
+          int, ffi.Pointer<ffi.Uint8>, ffi.Pointer<ffi.Uint32>, int)>();
+
+  void zenoh_undeclare_publisher(
+    int handle,
+  ) {
+    return _zenoh_undeclare_publisher(
+      handle,
+    );
+  }
+
+  late final _zenoh_undeclare_publisherPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Int)>>(
+          'zenoh_undeclare_publisher');
+  late final _zenoh_undeclare_publisher =
+      _zenoh_undeclare_publisherPtr.asFunction<void Function(int)>();
+
+  ffi.Pointer<ffi.Uint8> zenoh_buffer_alloc(
+    int size,
+  ) {
+    return _zenoh_buffer_alloc(
+      size,
+    );
+  }
+
+  late final _zenoh_buffer_allocPtr =
+      _lookup<ffi.NativeFunction<ffi.Pointer<ffi.Uint8> Function(ffi.Size)>>(
+          'zenoh_buffer_alloc');
+  late final _zenoh_buffer_alloc = _zenoh_buffer_allocPtr
+      .asFunction<ffi.Pointer<ffi.Uint8> Function(int)>();
+
+  int zenoh_publish_buffer(
+    int handle,
+    ffi.Pointer<ffi.Uint8> data,
+    int len,
+  ) {
+    return _zenoh_publish_buffer(
+      handle,
+      data,
+      len,
+    );
+  }
+
+  late final _zenoh_publish_bufferPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Int, ffi.Pointer<ffi.Uint8>,
+              ffi.Size)>>('zenoh_publish_buffer');
+  late final _zenoh_publish_buffer = _zenoh_publish_bufferPtr
+      .asFunction<int Function(int, ffi.Pointer<ffi.Uint8>, int)>();
+
+  void zenoh_buffer_free(
+    ffi.Pointer<ffi.Uint8> data,
+  ) {
+    return _zenoh_buffer_free(
+      data,
+    );
+  }
+
+  late final _zenoh_buffer_freePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Uint8>)>>(
+          'zenoh_buffer_free');
+  late final _zenoh_buffer_free =
+      _zenoh_buffer_freePtr.asFunction<void Function(ffi.Pointer<ffi.Uint8>)>();
+
+  int zenoh_shm_available() {
+    return _zenoh_shm_available();
+  }
+
+  late final _zenoh_shm_availablePtr =
+      _lookup<ffi.NativeFunction<ffi.Int Function()>>('zenoh_shm_available');
+  late final _zenoh_shm_available =
+      _zenoh_shm_availablePtr.asFunction<int Function()>();
+
+  ffi.Pointer<ffi.Void> zenoh_shm_alloc(
+    int size,
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> out_data,
+  ) {
+    return _zenoh_shm_alloc(
+      size,
+      out_data,
+    );
+  }
+
+  late final _zenoh_shm_allocPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Pointer<ffi.Void> Function(ffi.Size,
+              ffi.Pointer<ffi.Pointer<ffi.Uint8>>)>>('zenoh_shm_alloc');
+  late final _zenoh_shm_alloc = _zenoh_shm_allocPtr.asFunction<
+      ffi.Pointer<ffi.Void> Function(
+          int, ffi.Pointer<ffi.Pointer<ffi.Uint8>>)>();
+
+  int zenoh_publish_shm(
+    int handle,
+    ffi.Pointer<ffi.Void> shm_buffer,
+  ) {
+    return _zenoh_publish_shm(
+      handle,
+      shm_buffer,
+    );
+  }
+
+  late final _zenoh_publish_shmPtr = _lookup<
+          ffi.NativeFunction<ffi.Int Function(ffi.Int, ffi.Pointer<ffi.Void>)>>(
+      'zenoh_publish_shm');
+  late final _zenoh_publish_shm = _zenoh_publish_shmPtr
+      .asFunction<int Function(int, ffi.Pointer<ffi.Void>)>();
+
+  void zenoh_shm_free(
+    ffi.Pointer<ffi.Void> shm_buffer,
+  ) {
+    return _zenoh_shm_free(
+      shm_buffer,
+    );
+  }
+
+  late final _zenoh_shm_freePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'zenoh_shm_free');
+  late final _zenoh_shm_free =
+      _zenoh_shm_freePtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
   ffi.Pointer<ffi.Char> zenoh_get(
     ffi.Pointer<ffi.Char> key,
   ) {
@@ -185,6 +461,40 @@ class ZenohDartBindings {
   late final _zenoh_get = _zenoh_getPtr
       .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Char>)>();
 
+  int zenoh_get_async(
+    ffi.Pointer<ffi.Char> key,
+    ffi.Pointer<ffi.Char> parameters,
+    int timeout_ms,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
+    GetReplyCallback callback,
+    int request_id,
+  ) {
+    return _zenoh_get_async(
+      key,
+      parameters,
+      timeout_ms,
+      attachment,
+      attachment_len,
+      callback,
+      request_id,
+    );
+  }
+
+  late final _zenoh_get_asyncPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Char>,
+              ffi.Uint64,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              GetReplyCallback,
+              ffi.Int)>>('zenoh_get_async');
+  late final _zenoh_get_async = _zenoh_get_asyncPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>, int,
+          ffi.Pointer<ffi.Uint8>, int, GetReplyCallback, int)>();
+
   ffi.Pointer<ffi.Char> zenoh_get_with_handler(
     ffi.Pointer<ffi.Char> key,
   ) {
@@ -200,6 +510,106 @@ class ZenohDartBindings {
   late final _zenoh_get_with_handler = _zenoh_get_with_handlerPtr
       .asFunction<ffi.Pointer<ffi.Char> Function(ffi.Pointer<ffi.Char>)>();
 
+  int zenoh_declare_querier(
+    ffi.Pointer<ffi.Char> key_expr,
+    int target,
+    int consolidation,
+    int timeout_ms,
+  ) {
+    return _zenoh_declare_querier(
+      key_expr,
+      target,
+      consolidation,
+      timeout_ms,
+    );
+  }
+
+  late final _zenoh_declare_querierPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Int, ffi.Int,
+              ffi.Uint64)>>('zenoh_declare_querier');
+  late final _zenoh_declare_querier = _zenoh_declare_querierPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>, int, int, int)>();
+
+  int zenoh_querier_get(
+    int handle,
+    ffi.Pointer<ffi.Char> parameters,
+    ffi.Pointer<ffi.Uint8> payload,
+    int payload_len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
+    GetReplyCallback callback,
+    int request_id,
+  ) {
+    return _zenoh_querier_get(
+      handle,
+      parameters,
+      payload,
+      payload_len,
+      attachment,
+      attachment_len,
+      callback,
+      request_id,
+    );
+  }
+
+  late final _zenoh_querier_getPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Int,
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              GetReplyCallback,
+              ffi.Int)>>('zenoh_querier_get');
+  late final _zenoh_querier_get = _zenoh_querier_getPtr.asFunction<
+      int Function(int, ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Uint8>, int,
+          ffi.Pointer<ffi.Uint8>, int, GetReplyCallback, int)>();
+
+  void zenoh_undeclare_querier(
+    int handle,
+  ) {
+    return _zenoh_undeclare_querier(
+      handle,
+    );
+  }
+
+  late final _zenoh_undeclare_querierPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Int)>>(
+          'zenoh_undeclare_querier');
+  late final _zenoh_undeclare_querier =
+      _zenoh_undeclare_querierPtr.asFunction<void Function(int)>();
+
+  int zenoh_get_all(
+    ffi.Pointer<ffi.Char> key,
+    ffi.Pointer<ffi.Char> parameters,
+    int timeout_ms,
+    ffi.Pointer<ffi.Pointer<ffi.Uint8>> out_buf,
+    ffi.Pointer<ffi.Size> out_size,
+  ) {
+    return _zenoh_get_all(
+      key,
+      parameters,
+      timeout_ms,
+      out_buf,
+      out_size,
+    );
+  }
+
+  late final _zenoh_get_allPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Char>,
+              ffi.Uint64,
+              ffi.Pointer<ffi.Pointer<ffi.Uint8>>,
+              ffi.Pointer<ffi.Size>)>>('zenoh_get_all');
+  late final _zenoh_get_all = _zenoh_get_allPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Char>, int,
+          ffi.Pointer<ffi.Pointer<ffi.Uint8>>, ffi.Pointer<ffi.Size>)>();
+
   void zenoh_free_string(
     ffi.Pointer<ffi.Char> str,
   ) {
@@ -214,6 +624,34 @@ class ZenohDartBindings {
   late final _zenoh_free_string =
       _zenoh_free_stringPtr.asFunction<void Function(ffi.Pointer<ffi.Char>)>();
 
+  void zenoh_free_buffer(
+    ffi.Pointer<ffi.Uint8> buf,
+  ) {
+    return _zenoh_free_buffer(
+      buf,
+    );
+  }
+
+  late final _zenoh_free_bufferPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Uint8>)>>(
+          'zenoh_free_buffer');
+  late final _zenoh_free_buffer =
+      _zenoh_free_bufferPtr.asFunction<void Function(ffi.Pointer<ffi.Uint8>)>();
+
+  void zenoh_release(
+    ffi.Pointer<ffi.Void> buffer,
+  ) {
+    return _zenoh_release(
+      buffer,
+    );
+  }
+
+  late final _zenoh_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'zenoh_release');
+  late final _zenoh_release =
+      _zenoh_releasePtr.asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
   int zenoh_subscribe(
     ffi.Pointer<ffi.Char> key_expr,
     SubscriberCallback callback,
@@ -231,6 +669,270 @@ class ZenohDartBindings {
   late final _zenoh_subscribe = _zenoh_subscribePtr
       .asFunction<int Function(ffi.Pointer<ffi.Char>, SubscriberCallback)>();
 
+  int zenoh_subscribe_bytes(
+    ffi.Pointer<ffi.Char> key_expr,
+    SubscriberBytesCallback callback,
+  ) {
+    return _zenoh_subscribe_bytes(
+      key_expr,
+      callback,
+    );
+  }
+
+  late final _zenoh_subscribe_bytesPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>,
+              SubscriberBytesCallback)>>('zenoh_subscribe_bytes');
+  late final _zenoh_subscribe_bytes = _zenoh_subscribe_bytesPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, SubscriberBytesCallback)>();
+
+  void zenoh_sample_retain(
+    ffi.Pointer<ffi.Void> sample_handle,
+  ) {
+    return _zenoh_sample_retain(
+      sample_handle,
+    );
+  }
+
+  late final _zenoh_sample_retainPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'zenoh_sample_retain');
+  late final _zenoh_sample_retain = _zenoh_sample_retainPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  void zenoh_sample_release(
+    ffi.Pointer<ffi.Void> sample_handle,
+  ) {
+    return _zenoh_sample_release(
+      sample_handle,
+    );
+  }
+
+  late final _zenoh_sample_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'zenoh_sample_release');
+  late final _zenoh_sample_release = _zenoh_sample_releasePtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  void zenoh_init_dart_api(
+    ffi.Pointer<ffi.Void> post_cobject,
+  ) {
+    return _zenoh_init_dart_api(
+      post_cobject,
+    );
+  }
+
+  late final _zenoh_init_dart_apiPtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'zenoh_init_dart_api');
+  late final _zenoh_init_dart_api = _zenoh_init_dart_apiPtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  int zenoh_subscribe_port(
+    ffi.Pointer<ffi.Char> key_expr,
+    int port,
+  ) {
+    return _zenoh_subscribe_port(
+      key_expr,
+      port,
+    );
+  }
+
+  late final _zenoh_subscribe_portPtr = _lookup<
+          ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Int64)>>(
+      'zenoh_subscribe_port');
+  late final _zenoh_subscribe_port = _zenoh_subscribe_portPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>, int)>();
+
+  int zenoh_subscribe_ports(
+    ffi.Pointer<ffi.Char> key_expr,
+    ffi.Pointer<ffi.Int64> ports,
+    int port_count,
+  ) {
+    return _zenoh_subscribe_ports(
+      key_expr,
+      ports,
+      port_count,
+    );
+  }
+
+  late final _zenoh_subscribe_portsPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Int64>,
+              ffi.Int)>>('zenoh_subscribe_ports');
+  late final _zenoh_subscribe_ports = _zenoh_subscribe_portsPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Int64>, int)>();
+
+  int zenoh_subscribe_ring(
+    ffi.Pointer<ffi.Char> key_expr,
+    int capacity,
+  ) {
+    return _zenoh_subscribe_ring(
+      key_expr,
+      capacity,
+    );
+  }
+
+  late final _zenoh_subscribe_ringPtr = _lookup<
+          ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Size)>>(
+      'zenoh_subscribe_ring');
+  late final _zenoh_subscribe_ring = _zenoh_subscribe_ringPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>, int)>();
+
+  int zenoh_subscribe_fifo(
+    ffi.Pointer<ffi.Char> key_expr,
+    int capacity,
+  ) {
+    return _zenoh_subscribe_fifo(
+      key_expr,
+      capacity,
+    );
+  }
+
+  late final _zenoh_subscribe_fifoPtr = _lookup<
+          ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Size)>>(
+      'zenoh_subscribe_fifo');
+  late final _zenoh_subscribe_fifo = _zenoh_subscribe_fifoPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>, int)>();
+
+  int zenoh_subscribe_latest(
+    ffi.Pointer<ffi.Char> key_expr,
+    int capacity,
+  ) {
+    return _zenoh_subscribe_latest(
+      key_expr,
+      capacity,
+    );
+  }
+
+  late final _zenoh_subscribe_latestPtr = _lookup<
+          ffi.NativeFunction<ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Size)>>(
+      'zenoh_subscribe_latest');
+  late final _zenoh_subscribe_latest = _zenoh_subscribe_latestPtr
+      .asFunction<int Function(ffi.Pointer<ffi.Char>, int)>();
+
+  int zenoh_subscriber_drain(
+    int subscriber_id,
+    ffi.Pointer<ffi.Uint8> out_buf,
+    int buf_size,
+    int max_samples,
+  ) {
+    return _zenoh_subscriber_drain(
+      subscriber_id,
+      out_buf,
+      buf_size,
+      max_samples,
+    );
+  }
+
+  late final _zenoh_subscriber_drainPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Int, ffi.Pointer<ffi.Uint8>, ffi.Size,
+              ffi.Int)>>('zenoh_subscriber_drain');
+  late final _zenoh_subscriber_drain = _zenoh_subscriber_drainPtr
+      .asFunction<int Function(int, ffi.Pointer<ffi.Uint8>, int, int)>();
+
+  int zenoh_declare_queryable(
+    ffi.Pointer<ffi.Char> key_expr,
+    int mode,
+    QueryCallback callback,
+    int capacity,
+  ) {
+    return _zenoh_declare_queryable(
+      key_expr,
+      mode,
+      callback,
+      capacity,
+    );
+  }
+
+  late final _zenoh_declare_queryablePtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Pointer<ffi.Char>, ffi.Int, QueryCallback,
+              ffi.Size)>>('zenoh_declare_queryable');
+  late final _zenoh_declare_queryable = _zenoh_declare_queryablePtr.asFunction<
+      int Function(ffi.Pointer<ffi.Char>, int, QueryCallback, int)>();
+
+  int zenoh_queryable_drain(
+    int handle,
+    ffi.Pointer<ffi.Uint8> out_buf,
+    int buf_size,
+    int max_queries,
+  ) {
+    return _zenoh_queryable_drain(
+      handle,
+      out_buf,
+      buf_size,
+      max_queries,
+    );
+  }
+
+  late final _zenoh_queryable_drainPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(ffi.Int, ffi.Pointer<ffi.Uint8>, ffi.Size,
+              ffi.Int)>>('zenoh_queryable_drain');
+  late final _zenoh_queryable_drain = _zenoh_queryable_drainPtr
+      .asFunction<int Function(int, ffi.Pointer<ffi.Uint8>, int, int)>();
+
+  int zenoh_query_reply(
+    ffi.Pointer<ffi.Void> query_handle,
+    ffi.Pointer<ffi.Uint8> payload,
+    int len,
+    ffi.Pointer<ffi.Char> encoding,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
+  ) {
+    return _zenoh_query_reply(
+      query_handle,
+      payload,
+      len,
+      encoding,
+      attachment,
+      attachment_len,
+    );
+  }
+
+  late final _zenoh_query_replyPtr = _lookup<
+      ffi.NativeFunction<
+          ffi.Int Function(
+              ffi.Pointer<ffi.Void>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size,
+              ffi.Pointer<ffi.Char>,
+              ffi.Pointer<ffi.Uint8>,
+              ffi.Size)>>('zenoh_query_reply');
+  late final _zenoh_query_reply = _zenoh_query_replyPtr.asFunction<
+      int Function(ffi.Pointer<ffi.Void>, ffi.Pointer<ffi.Uint8>, int,
+          ffi.Pointer<ffi.Char>, ffi.Pointer<ffi.Uint8>, int)>();
+
+  void zenoh_query_release(
+    ffi.Pointer<ffi.Void> query_handle,
+  ) {
+    return _zenoh_query_release(
+      query_handle,
+    );
+  }
+
+  late final _zenoh_query_releasePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Pointer<ffi.Void>)>>(
+          'zenoh_query_release');
+  late final _zenoh_query_release = _zenoh_query_releasePtr
+      .asFunction<void Function(ffi.Pointer<ffi.Void>)>();
+
+  void zenoh_undeclare_queryable(
+    int handle,
+  ) {
+    return _zenoh_undeclare_queryable(
+      handle,
+    );
+  }
+
+  late final _zenoh_undeclare_queryablePtr =
+      _lookup<ffi.NativeFunction<ffi.Void Function(ffi.Int)>>(
+          'zenoh_undeclare_queryable');
+  late final _zenoh_undeclare_queryable =
+      _zenoh_undeclare_queryablePtr.asFunction<void Function(int)>();
+
   void zenoh_unsubscribe(
     int subscriber_id,
   ) {
@@ -255,47 +957,742 @@ class ZenohDartBindings {
       _zenoh_unsubscribe_allPtr.asFunction<void Function()>();
 }
 
-/// Subscriber structure
+/// Subscriber structure - hot fields only, read on every sample
 final class subscriber_t extends ffi.Struct {
-  external z_owned_subscriber_t subscriber;
-
   external SubscriberCallback callback;
 
-  @ffi.Bool()
-  external bool active;
+  external SubscriberBytesCallback bytes_callback;
 
   @ffi.Int()
   external int id;
 
-  @ffi.Array.multi([256])
-  external ffi.Array<ffi.Char> key_expr;
+  @ffi.Bool()
+  external bool active;
 }
 
-/// An owned Zenoh <a href="https://zenoh.io/docs/manual/abstractions/#subscriber"> subscriber </a>.
-///
-/// Receives data from publication on intersecting key expressions.
-/// Destroying the subscriber cancels the subscription.
-final class z_owned_subscriber_t extends ffi.Struct {
-  @ffi.Array.multi([48])
-  external ffi.Array<ffi.Uint8> _0;
+/// Latest sample of one key of a coalescing subscriber
+final class latest_entry_t extends ffi.Struct {
+  /// NULL for an empty bucket
+  external ffi.Pointer<ffi.Char> key;
+
+  @ffi.Size()
+  external int key_len;
+
+  @ffi.Uint64()
+  external int hash;
+
+  external z_owned_sample_t sample;
+
+  /// Updated since it was last drained
+  @ffi.Bool()
+  external bool dirty;
+}
+
+/// Open-addressing map from key to its latest sample, written by the zenoh
+/// callback thread and read by zenoh_subscriber_drain()
+final class latest_map_t extends ffi.Struct {
+  external ffi.Pointer<latest_entry_t> entries;
+
+  /// Power of two
+  @ffi.Size()
+  external int bucket_count;
+
+  @ffi.Size()
+  external int count;
+
+  @ffi.Size()
+  external int dirty_count;
+
+  /// Bucket the next drain resumes from
+  @ffi.Size()
+  external int cursor;
+
+  external z_owned_mutex_t mutex;
+}
+
+/// Native sample channel of a pull-mode subscriber, drained by Dart in bulk
+final class pull_channel_t extends ffi.Struct {
+  @ffi.Int()
+  external int mode;
+
+  @ffi.Size()
+  external int capacity;
+
+  /// SUBSCRIBER_MODE_RING
+  external z_owned_ring_handler_sample_t ring;
+
+  /// SUBSCRIBER_MODE_FIFO
+  external z_owned_fifo_handler_sample_t fifo;
+
+  /// SUBSCRIBER_MODE_LATEST, owned by the subscriber closure
+  external latest_map_t latest;
+
+  /// Did not fit the last drain buffer
+  external z_owned_sample_t pending;
+
+  @ffi.Bool()
+  external bool has_pending;
+}
+
+/// An owned Zenoh ring sample handler.
+final class z_owned_ring_handler_sample_t extends ffi.Struct {
+  @ffi.Array.multi([8])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// An owned Zenoh fifo sample handler.
+final class z_owned_fifo_handler_sample_t extends ffi.Struct {
+  @ffi.Array.multi([8])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// Cold subscriber fields, only touched on subscribe/unsubscribe
+final class subscriber_info_t extends ffi.Struct {
+  external z_owned_subscriber_t subscriber;
+
+  /// NULL for callback subscribers
+  external ffi.Pointer<pull_channel_t> pull;
+
+  external ffi.Pointer<ffi.Char> key_expr;
+
+  /// Next free index while the record is unused, -1 ends the list
+  @ffi.Int()
+  external int next_free;
+
+  /// subscriber is set, false while z_declare_subscriber() runs unlocked
+  @ffi.Bool()
+  external bool declared;
+}
+
+/// One slab of subscriber records
+final class subscriber_chunk_t extends ffi.Struct {
+  @ffi.Array.multi([64])
+  external ffi.Array<subscriber_t> hot;
+
+  @ffi.Array.multi([64])
+  external ffi.Array<subscriber_info_t> cold;
+}
+
+/// Growable subscriber table with an intrusive free list
+final class subscriber_table_t extends ffi.Struct {
+  external ffi.Pointer<ffi.Pointer<subscriber_chunk_t>> chunks;
+
+  @ffi.Int()
+  external int chunk_count;
+
+  @ffi.Int()
+  external int chunk_capacity;
+
+  /// -1 when every allocated record is in use
+  @ffi.Int()
+  external int free_head;
+
+  /// Guards table layout, not sample dispatch
+  external z_owned_mutex_t mutex;
+}
+
+/// Closure context - direct reference to the subscriber record, checked against its id
+final class subscriber_ref_t extends ffi.Struct {
+  external ffi.Pointer<subscriber_t> sub;
+
+  @ffi.Int()
+  external int id;
+}
+
+/// Closure context of a port subscriber, samples are sharded across ports by
+/// key hash so every key keeps its order on one port
+final class port_ref_t extends ffi.Struct {
+  external subscriber_ref_t ref;
+
+  @ffi.Int()
+  external int port_count;
+
+  @ffi.Array.multi([0])
+  external ffi.Array<ffi.Int64> ports;
+}
+
+/// An owned Zenoh <a href="https://zenoh.io/docs/manual/abstractions/#subscriber"> subscriber </a>.
+///
+/// Receives data from publication on intersecting key expressions.
+/// Destroying the subscriber cancels the subscription.
+final class z_owned_subscriber_t extends ffi.Struct {
+  @ffi.Array.multi([48])
+  external ffi.Array<ffi.Uint8> _0;
 }
 
 /// Callback function pointer type for Flutter
+/// key_id >= 0: key is interned and stays valid while the library is loaded
+/// key_id < 0: the intern table is full and key lives in the value block
+/// kind is a z_sample_kind_t, Dart returns the block with zenoh_release(value)
+/// attachment is NULL when the sample carries none, otherwise attachment_len
+/// bytes copied into the value block
 typedef SubscriberCallback
     = ffi.Pointer<ffi.NativeFunction<SubscriberCallbackFunction>>;
 typedef SubscriberCallbackFunction = ffi.Void Function(
     ffi.Pointer<ffi.Char> key,
+    ffi.Int key_id,
     ffi.Pointer<ffi.Char> value,
-    ffi.Pointer<ffi.Char> kind,
-    ffi.Pointer<ffi.Char> attachment,
+    ffi.Int kind,
+    ffi.Pointer<ffi.Uint8> attachment,
+    ffi.Size attachment_len,
     ffi.Int subscriber_id);
 typedef DartSubscriberCallbackFunction = void Function(
     ffi.Pointer<ffi.Char> key,
+    int key_id,
     ffi.Pointer<ffi.Char> value,
-    ffi.Pointer<ffi.Char> kind,
-    ffi.Pointer<ffi.Char> attachment,
+    int kind,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
     int subscriber_id);
 
+/// Binary callback function pointer type for Flutter
+/// key/payload/attachment point into the sample held by sample_handle, valid until zenoh_sample_release()
+/// attachment is NULL when the sample carries none
+/// is_shm is set when payload is a shared memory mapping rather than a zenoh buffer
+typedef SubscriberBytesCallback
+    = ffi.Pointer<ffi.NativeFunction<SubscriberBytesCallbackFunction>>;
+typedef SubscriberBytesCallbackFunction = ffi.Void Function(
+    ffi.Pointer<ffi.Char> key,
+    ffi.Size key_len,
+    ffi.Pointer<ffi.Uint8> payload,
+    ffi.Size payload_len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    ffi.Size attachment_len,
+    ffi.Int kind,
+    ffi.Int is_shm,
+    ffi.Pointer<ffi.Void> sample_handle,
+    ffi.Int subscriber_id);
+typedef DartSubscriberBytesCallbackFunction = void Function(
+    ffi.Pointer<ffi.Char> key,
+    int key_len,
+    ffi.Pointer<ffi.Uint8> payload,
+    int payload_len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
+    int kind,
+    int is_shm,
+    ffi.Pointer<ffi.Void> sample_handle,
+    int subscriber_id);
+
+/// Queryable callback function pointer type for Flutter
+/// key/parameters/payload/attachment point into the query held by query_handle, valid until zenoh_query_release()
+typedef QueryCallback = ffi.Pointer<ffi.NativeFunction<QueryCallbackFunction>>;
+typedef QueryCallbackFunction = ffi.Void Function(
+    ffi.Int queryable_handle,
+    ffi.Pointer<ffi.Char> key,
+    ffi.Size key_len,
+    ffi.Pointer<ffi.Char> parameters,
+    ffi.Size parameters_len,
+    ffi.Pointer<ffi.Uint8> payload,
+    ffi.Size payload_len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    ffi.Size attachment_len,
+    ffi.Pointer<ffi.Void> query_handle);
+typedef DartQueryCallbackFunction = void Function(
+    int queryable_handle,
+    ffi.Pointer<ffi.Char> key,
+    int key_len,
+    ffi.Pointer<ffi.Char> parameters,
+    int parameters_len,
+    ffi.Pointer<ffi.Uint8> payload,
+    int payload_len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
+    ffi.Pointer<ffi.Void> query_handle);
+
+/// Sample record written by zenoh_subscriber_drain(), followed by the key,
+/// payload and attachment bytes, the next record starts size bytes after this one
+final class sample_record_t extends ffi.Struct {
+  /// Record size including padding to 8 bytes
+  @ffi.Uint32()
+  external int size;
+
+  @ffi.Uint32()
+  external int key_len;
+
+  @ffi.Uint32()
+  external int payload_len;
+
+  @ffi.Uint32()
+  external int kind;
+
+  /// NTP64 time, 0 when the sample carries none
+  @ffi.Uint64()
+  external int timestamp;
+  /// Attachment bytes follow the payload
+  @ffi.Uint32()
+  external int attachment_len;
+}
+
+/// Reply record in a zenoh_get_all() result buffer, followed by the key,
+/// payload and encoding bytes, the next record starts at the next 8 byte boundary
+final class reply_record_t extends ffi.Struct {
+  @ffi.Uint32()
+  external int key_len;
+
+  @ffi.Uint32()
+  external int payload_len;
+
+  @ffi.Uint32()
+  external int encoding_len;
+
+  @ffi.Uint32()
+  external int is_error;
+
+  /// NTP64 time, 0 when the sample carries none
+  @ffi.Uint64()
+  external int timestamp;
+}
+
+/// Interned key, the string is never freed so Dart can cache it by id
+final class key_bucket_t extends ffi.Struct {
+  /// NULL for an empty bucket
+  external ffi.Pointer<ffi.Char> key;
+
+  @ffi.Size()
+  external int key_len;
+
+  @ffi.Uint64()
+  external int hash;
+
+  @ffi.Int()
+  external int id;
+}
+
+/// Open-addressing table of interned sample keys, shared by every subscriber
+final class key_table_t extends ffi.Struct {
+  external ffi.Pointer<key_bucket_t> buckets;
+
+  /// Power of two
+  @ffi.Size()
+  external int bucket_count;
+
+  @ffi.Int()
+  external int count;
+
+  external z_owned_mutex_t mutex;
+}
+
+/// A key expression declared with z_declare_keyexpr(), sent as a numeric id
+final class keyexpr_entry_t extends ffi.Struct {
+  external z_owned_keyexpr_t keyexpr;
+
+  external ffi.Pointer<ffi.Char> key;
+
+  @ffi.Uint64()
+  external int hash;
+
+  /// Cache clock at the last hit, for LRU eviction
+  @ffi.Uint64()
+  external int last_used;
+
+  /// Puts and gets in flight, pins the entry
+  @ffi.Int()
+  external int users;
+
+  /// Next entry in the same bucket, -1 ends the chain
+  @ffi.Int()
+  external int next;
+
+  @ffi.Bool()
+  external bool active;
+}
+
+/// A Zenoh-allocated key expression.
+final class z_owned_keyexpr_t extends ffi.Struct {
+  @ffi.Array.multi([32])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// Uses of a key not declared yet, slots are shared by keys with the same low hash bits
+final class keyexpr_admit_t extends ffi.Struct {
+  @ffi.Uint64()
+  external int hash;
+
+  @ffi.Uint32()
+  external int count;
+}
+
+/// LRU of declared key expressions, looked up by key hash
+final class keyexpr_cache_t extends ffi.Struct {
+  @ffi.Array.multi([64])
+  external ffi.Array<keyexpr_entry_t> entries;
+
+  /// First entry of each chain, -1 when empty
+  @ffi.Array.multi([128])
+  external ffi.Array<ffi.Int> buckets;
+
+  @ffi.Array.multi([256])
+  external ffi.Array<keyexpr_admit_t> admit;
+
+  @ffi.Uint64()
+  external int clock;
+
+  @ffi.Uint64()
+  external int hits;
+
+  @ffi.Uint64()
+  external int misses;
+
+  external z_owned_mutex_t mutex;
+}
+
+/// One slab size class, blocks are carved from a single region and the free
+/// list links them by index so the head can carry an ABA tag
+final class slab_class_t extends ffi.Struct {
+  external ffi.Pointer<ffi.Uint8> base;
+
+  /// Next free block after each block
+  external ffi.Pointer<ffi.Uint32> next;
+
+  /// ABA tag in the high half, first free block in the low half
+  @ffi.Uint64()
+  external int head;
+
+  @ffi.Size()
+  external int block_size;
+
+  @ffi.Uint32()
+  external int block_count;
+}
+
+/// Header in front of every publish buffer, the payload follows it
+final class pool_buffer_t extends ffi.Struct {
+  external ffi.Pointer<pool_buffer_t> next_free;
+
+  @ffi.Size()
+  external int capacity;
+
+  /// -1 for oversized buffers
+  @ffi.Int()
+  external int size_class;
+}
+
+/// Free lists of publish buffers, refilled by the zenoh deleter threads
+final class publish_pool_t extends ffi.Struct {
+  @ffi.Array.multi([13])
+  external ffi.Array<ffi.Pointer<pool_buffer_t>> free_lists;
+
+  @ffi.Array.multi([13])
+  external ffi.Array<ffi.Int> free_counts;
+
+  external z_owned_mutex_t mutex;
+}
+
+/// Writable buffer handed to Dart by zenoh_shm_alloc(), consumed by zenoh_publish_shm()
+final class shm_buffer_t extends ffi.Struct {
+  external ffi.Pointer<ffi.Uint8> data;
+
+  @ffi.Size()
+  external int len;
+
+  /// false when backed by the heap because SHM is unavailable
+  @ffi.Bool()
+  external bool is_shm;
+}
+
+/// Per-request context of an async get, owned by the reply closure
+final class get_context_t extends ffi.Struct {
+  external GetReplyCallback callback;
+
+  @ffi.Int()
+  external int request_id;
+}
+
+/// Async get callback - called once per reply, then once with ZENOH_REPLY_DONE
+/// key/payload/attachment point into reply_handle, valid until zenoh_sample_release()
+typedef GetReplyCallback
+    = ffi.Pointer<ffi.NativeFunction<GetReplyCallbackFunction>>;
+typedef GetReplyCallbackFunction = ffi.Void Function(
+    ffi.Int request_id,
+    ffi.Int status,
+    ffi.Pointer<ffi.Char> key,
+    ffi.Size key_len,
+    ffi.Pointer<ffi.Uint8> payload,
+    ffi.Size payload_len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    ffi.Size attachment_len,
+    ffi.Pointer<ffi.Void> reply_handle);
+typedef DartGetReplyCallbackFunction = void Function(
+    int request_id,
+    int status,
+    ffi.Pointer<ffi.Char> key,
+    int key_len,
+    ffi.Pointer<ffi.Uint8> payload,
+    int payload_len,
+    ffi.Pointer<ffi.Uint8> attachment,
+    int attachment_len,
+    ffi.Pointer<ffi.Void> reply_handle);
+
+/// Publisher declaration and put options, NULL means zenoh defaults
+final class publisher_options_t extends ffi.Struct {
+  external ffi.Pointer<ffi.Char> encoding;
+
+  /// z_priority_t
+  @ffi.Int()
+  external int priority;
+
+  /// z_congestion_control_t
+  @ffi.Int()
+  external int congestion_control;
+
+  /// 1 sends without batching
+  @ffi.Int()
+  external int is_express;
+
+  /// z_reliability_t, ignored without Z_FEATURE_UNSTABLE_API
+  @ffi.Int()
+  external int reliability;
+}
+
+/// Publisher structure
+final class publisher_t extends ffi.Struct {
+  external z_owned_publisher_t publisher;
+
+  @ffi.Bool()
+  external bool active;
+
+  @ffi.Array.multi([256])
+  external ffi.Array<ffi.Char> key_expr;
+}
+
+/// A publisher declared by zenoh_publish() for one key
+final class publish_cache_entry_t extends ffi.Struct {
+  external z_owned_publisher_t publisher;
+
+  external ffi.Pointer<ffi.Char> key;
+
+  @ffi.Uint64()
+  external int hash;
+
+  /// Cache clock at the last publish, for LRU eviction
+  @ffi.Uint64()
+  external int last_used;
+
+  /// Publishes in flight, pins the entry
+  @ffi.Int()
+  external int users;
+
+  /// Next entry in the same bucket, -1 ends the chain
+  @ffi.Int()
+  external int next;
+
+  @ffi.Bool()
+  external bool active;
+}
+
+/// LRU of zenoh_publish() publishers, looked up by key hash
+final class publish_cache_t extends ffi.Struct {
+  @ffi.Array.multi([32])
+  external ffi.Array<publish_cache_entry_t> entries;
+
+  /// First entry of each chain, -1 when empty
+  @ffi.Array.multi([64])
+  external ffi.Array<ffi.Int> buckets;
+
+  @ffi.Uint64()
+  external int clock;
+
+  external z_owned_mutex_t mutex;
+}
+
+/// Querier structure - routing to the queryables of key_expr is resolved once
+final class querier_t extends ffi.Struct {
+  external z_owned_querier_t querier;
+
+  @ffi.Bool()
+  external bool active;
+
+  @ffi.Array.multi([256])
+  external ffi.Array<ffi.Char> key_expr;
+}
+
+/// An owned Zenoh querier.
+///
+/// Sends queries to matching queryables.
+final class z_owned_querier_t extends ffi.Struct {
+  @ffi.Array.multi([80])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// Per-call state of a blocking zenoh_get, passed as the reply closure context
+final class get_sync_context_t extends ffi.Struct {
+  external z_owned_mutex_t mutex;
+
+  external z_owned_condvar_t condvar;
+
+  /// First successful reply, handed over to the caller
+  external ffi.Pointer<ffi.Char> value;
+
+  /// Caller stopped waiting, later replies are ignored
+  @ffi.Bool()
+  external bool taken;
+
+  /// Query finished, no more replies will arrive
+  @ffi.Bool()
+  external bool done;
+
+  /// Caller + closure, guarded by mutex
+  @ffi.Int()
+  external int refs;
+}
+
+/// An owned mutex.
+final class z_owned_mutex_t extends ffi.Struct {
+  @ffi.Array.multi([32])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// An owned conditional variable.
+///
+/// Used in combination with `z_owned_mutex_t` to wake up thread when certain conditions are met.
+final class z_owned_condvar_t extends ffi.Struct {
+  @ffi.Array.multi([24])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// Sample handle handed to Dart by the binary subscriber path
+final class sample_handle_t extends ffi.Struct {
+  external z_owned_sample_t sample;
+
+  /// Only used when the payload is fragmented
+  external z_owned_slice_t slice;
+
+  /// Only used when the attachment is fragmented
+  external z_owned_slice_t attachment_slice;
+
+  @ffi.Bool()
+  external bool owns_slice;
+
+  @ffi.Bool()
+  external bool owns_attachment_slice;
+
+  /// Payload view points into a shared memory mapping
+  @ffi.Bool()
+  external bool is_shm;
+
+  /// Dropped by zenoh_sample_release(), starts at 1
+  @ffi.Int()
+  external int refs;
+}
+
+/// Query handle handed to Dart, replied to with zenoh_query_reply()
+final class query_handle_t extends ffi.Struct {
+  external z_owned_query_t query;
+
+  /// Only used when the payload is fragmented
+  external z_owned_slice_t slice;
+
+  /// Only used when the attachment is fragmented
+  external z_owned_slice_t attachment_slice;
+
+  @ffi.Bool()
+  external bool owns_slice;
+
+  @ffi.Bool()
+  external bool owns_attachment_slice;
+
+  external ffi.Pointer<ffi.Uint8> payload;
+
+  @ffi.Size()
+  external int payload_len;
+
+  /// NULL when the query carries none
+  external ffi.Pointer<ffi.Uint8> attachment;
+
+  @ffi.Size()
+  external int attachment_len;
+}
+
+/// An owned Zenoh query received by a queryable.
+///
+/// Queries are atomically reference-counted, letting you extract them from the callback that handed them to you by cloning.
+final class z_owned_query_t extends ffi.Struct {
+  @ffi.Array.multi([136])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// Query record written by zenoh_queryable_drain(), followed by the key,
+/// parameters, payload and attachment bytes, the next record starts size bytes
+/// after this one
+final class query_record_t extends ffi.Struct {
+  /// Record size including padding to 8 bytes
+  @ffi.Uint32()
+  external int size;
+
+  @ffi.Uint32()
+  external int key_len;
+
+  @ffi.Uint32()
+  external int parameters_len;
+
+  @ffi.Uint32()
+  external int payload_len;
+
+  /// query_handle_t*, owned by Dart once drained
+  @ffi.Uint64()
+  external int query_handle;
+
+  @ffi.Uint32()
+  external int attachment_len;
+}
+
+/// Closure context of a callback-mode queryable, freed by the closure drop
+final class queryable_context_t extends ffi.Struct {
+  external QueryCallback callback;
+
+  @ffi.Int()
+  external int handle;
+}
+
+/// Queryable structure
+final class queryable_t extends ffi.Struct {
+  external z_owned_queryable_t queryable;
+
+  @ffi.Int()
+  external int mode;
+
+  /// QUERYABLE_MODE_RING
+  external z_owned_ring_handler_query_t ring;
+
+  /// Did not fit the last drain buffer
+  external ffi.Pointer<query_handle_t> pending;
+
+  @ffi.Bool()
+  external bool active;
+
+  @ffi.Array.multi([256])
+  external ffi.Array<ffi.Char> key_expr;
+}
+
+/// An owned Zenoh <a href="https://zenoh.io/docs/manual/abstractions/#queryable"> queryable </a>.
+///
+/// Responds to queries sent via `z_get()` with intersecting key expression.
+final class z_owned_queryable_t extends ffi.Struct {
+  @ffi.Array.multi([48])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// An owned Zenoh ring query handler.
+final class z_owned_ring_handler_query_t extends ffi.Struct {
+  @ffi.Array.multi([8])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+/// An owned Zenoh sample.
+///
+/// This is a read only type that can only be constructed by cloning a `z_loaned_sample_t`.
+/// Like all owned types, it should be freed using z_drop or z_sample_drop.
+final class z_owned_sample_t extends ffi.Struct {
+  @ffi.Array.multi([184])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
+final class z_owned_slice_t extends ffi.Struct {
+  @ffi.Array.multi([32])
+  external ffi.Array<ffi.Uint8> _0;
+}
+
 /// An owned Zenoh session.
 final class z_owned_session_t extends ffi.Struct {
   @ffi.Array.multi([8])
@@ -342,4 +1739,64 @@ const String Z_CONFIG_ADD_TIMESTAMP_KEY = 'timestamping/enabled';
 
 const String Z_CONFIG_SHARED_MEMORY_KEY = 'transport/shared_memory/enabled';
 
-const int MAX_SUBSCRIBERS = 32;
+const int ZENOH_REPLY_OK = 0;
+
+const int ZENOH_REPLY_ERROR = 1;
+
+const int ZENOH_REPLY_DONE = 2;
+
+const int SUBSCRIBER_MODE_CALLBACK = 0;
+
+const int SUBSCRIBER_MODE_RING = 1;
+
+const int SUBSCRIBER_MODE_FIFO = 2;
+
+const int SUBSCRIBER_MODE_LATEST = 3;
+
+const int SUBSCRIBER_INDEX_BITS = 20;
+
+const int SUBSCRIBER_INDEX_MASK = 1048575;
+
+const int MAX_SUBSCRIBERS = 1048576;
+
+const int SUBSCRIBER_CHUNK_SIZE = 64;
+
+const int MAX_PORT_SHARDS = 64;
+
+const int ZENOH_OPTION_DEFAULT = -1;
+
+const int MAX_PUBLISHERS = 64;
+
+const int PUBLISH_CACHE_SIZE = 32;
+
+const int PUBLISH_CACHE_BUCKETS = 64;
+
+const int KEY_TABLE_MAX = 65536;
+
+const int KEYEXPR_CACHE_SIZE = 64;
+
+const int KEYEXPR_CACHE_BUCKETS = 128;
+
+const int KEYEXPR_ADMIT_SLOTS = 256;
+
+const int KEYEXPR_ADMIT_HITS = 3;
+
+const int SLAB_CLASSES = 4;
+
+const int SLAB_EMPTY = 4294967295;
+
+const int PUBLISH_POOL_MIN_SHIFT = 12;
+
+const int PUBLISH_POOL_CLASSES = 13;
+
+const int PUBLISH_POOL_MAX_FREE = 8;
+
+const int ZENOH_SHM_POOL_SIZE = 67108864;
+
+const int MAX_QUERIERS = 64;
+
+const int MAX_QUERYABLES = 64;
+
+const int QUERYABLE_MODE_CALLBACK = 0;
+
+const int QUERYABLE_MODE_RING = 1;
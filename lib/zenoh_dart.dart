@@ -3,22 +3,903 @@
 import 'dart:async';
 import 'dart:ffi';
 import 'dart:io';
+import 'dart:isolate';
+import 'dart:typed_data';
 import 'package:ffi/ffi.dart';
 import 'dart:convert';
 
 import 'src/gen/zenoh_dart_bindings_generated.dart';
 
-typedef DartSubscriberCallback = void Function(
-    String key, String value, String kind, String attachment, int subscriberId);
+/// [attachment] is null when the sample carries none, otherwise a copy of
+/// its raw bytes. It used to be a `String`; decode it with `utf8.decode`
+/// where text is expected.
+typedef DartSubscriberCallback = void Function(String key, String value,
+    String kind, Uint8List? attachment, int subscriberId);
+
+typedef DartSubscriberBytesCallback = void Function(ZenohSample sample);
+
+typedef DartQueryCallback = void Function(ZenohQuery query);
+
+/// A received sample whose text fields are decoded only when accessed.
+///
+/// [keyBytes] and [payloadBytes] are the raw bytes as delivered; [key] and
+/// [payloadString] decode them on first use and cache the result, so
+/// consumers that filter on a few samples or forward payloads untouched skip
+/// UTF-8 decoding for the rest.
+abstract class Sample {
+  /// UTF-8 bytes of the sample key
+  Uint8List get keyBytes;
+
+  Uint8List get payloadBytes;
+
+  /// Attachment sent alongside the payload, null when the sample has none
+  Uint8List? get attachmentBytes;
+
+  int get kind;
+
+  late final String key = utf8.decode(keyBytes, allowMalformed: true);
+
+  late final String payloadString =
+      utf8.decode(payloadBytes, allowMalformed: true);
+}
+
+/// A sample received through [ZenohDart.subscribeBytes].
+///
+/// [payload] is a view into native memory held by the sample, not a copy;
+/// for shared memory payloads ([isShm]) it is the mapping itself. The view
+/// keeps its own reference on the sample, dropped by the garbage collector
+/// once the view is unreachable, so it stays valid after [release]. Call
+/// [release] once done to drop the sample's reference promptly; samples
+/// that are never released are dropped when collected. [attachment] is a
+/// view held the same way.
+class ZenohSample extends Sample implements Finalizable {
+  static final _finalizer = NativeFinalizer(ZenohDart._sampleReleasePtr);
+
+  @override
+  final Uint8List keyBytes;
+  final Uint8List payload;
+  final Uint8List? attachment;
+  @override
+  final int kind;
+  final bool isShm;
+  final int subscriberId;
+  Pointer<Void> _handle;
+
+  ZenohSample._(this.keyBytes, this.payload, this.attachment, this.kind,
+      this.isShm, this.subscriberId, this._handle) {
+    _finalizer.attach(this, _handle, detach: this);
+  }
+
+  @override
+  Uint8List get payloadBytes => payload;
+
+  @override
+  Uint8List? get attachmentBytes => attachment;
+
+  bool get isReleased => _handle.address == 0;
+
+  /// Drop this sample's reference on the native sample
+  void release() {
+    if (_handle.address == 0) return;
+    _finalizer.detach(this);
+    ZenohDart._bindings.zenoh_sample_release(_handle);
+    _handle = nullptr;
+  }
+}
+
+/// A reply received through [ZenohDart.getReplies].
+///
+/// [payload] and [attachment] are views into native memory held by the reply,
+/// not copies. Call [release] once done with it; the views must not be used
+/// afterwards.
+class ZenohReply {
+  /// Key of the replying sample, empty for error replies
+  final String key;
+  final Uint8List payload;
+
+  /// Attachment of the replying sample, null when it has none
+  final Uint8List? attachment;
+  final bool isError;
+  Pointer<Void> _handle;
+
+  ZenohReply._(
+      this.key, this.payload, this.attachment, this.isError, this._handle);
+
+  bool get isReleased => _handle.address == 0;
+
+  String get payloadString => utf8.decode(payload, allowMalformed: true);
+
+  /// Drop the native reply backing [payload]
+  void release() {
+    if (_handle.address == 0) return;
+    ZenohDart._bindings.zenoh_sample_release(_handle);
+    _handle = nullptr;
+  }
+}
+
+/// A reply collected by [ZenohDart.getAll], copied into Dart memory.
+class ZenohReplyData {
+  /// Key of the replying sample, empty for error replies
+  final String key;
+  final Uint8List payload;
+  final String encoding;
+
+  /// NTP64 timestamp of the sample, 0 when it carries none
+  final int timestamp;
+  final bool isError;
+
+  ZenohReplyData(
+      this.key, this.payload, this.encoding, this.timestamp, this.isError);
+
+  String get payloadString => utf8.decode(payload, allowMalformed: true);
+}
+
+/// A sample drained from a [PullSubscriber].
+///
+/// [payload] and [attachment] are views into the [SampleArena] the sample was
+/// drained into and are only valid until that arena is drained again; copy
+/// them to keep them longer. [keyBytes] is copied out of the arena, so [key]
+/// stays valid for the lifetime of the sample.
+class DrainedSample extends Sample {
+  @override
+  final Uint8List keyBytes;
+  final Uint8List payload;
+
+  /// View like [payload], null when the sample has no attachment
+  final Uint8List? attachment;
+  @override
+  final int kind;
+
+  /// NTP64 timestamp of the sample, 0 when it carries none
+  final int timestamp;
+
+  DrainedSample._(
+      this.keyBytes, this.payload, this.attachment, this.kind, this.timestamp);
+
+  @override
+  Uint8List get payloadBytes => payload;
+
+  @override
+  Uint8List? get attachmentBytes => attachment;
+
+  /// Decode a message posted by a port subscriber, see
+  /// [ZenohDart.subscribeToPort]; the payload is a view into [message]
+  factory DrainedSample.fromMessage(Uint8List message) =>
+      _decodeSampleRecords(message, 1).single;
+}
+
+/// A subscriber whose samples the native layer posts straight to a port.
+///
+/// Each sample arrives as one native-backed [Uint8List], released by the VM
+/// once unreachable, so delivery involves no callback trampoline, string
+/// decoding or manual freeing.
+class PortSubscriber {
+  final String key;
+  final int id;
+  final ReceivePort _port;
+  bool _closed = false;
+
+  /// Samples in arrival order
+  late final Stream<DrainedSample> samples = _port
+      .cast<Uint8List>()
+      .map((message) => DrainedSample.fromMessage(message));
+
+  PortSubscriber._(this.key, this.id, this._port);
+
+  bool get isClosed => _closed;
+
+  /// Unsubscribe and close the receiving port
+  void close() {
+    if (_closed) return;
+    ZenohDart.unsubscribe(id);
+    _port.close();
+    _closed = true;
+  }
+}
+
+/// A preallocated native buffer pull subscribers drain samples into.
+///
+/// One arena can be reused across frames and across subscribers, so steady
+/// state draining allocates no native memory.
+class SampleArena {
+  Pointer<Uint8> _ptr;
+  int _size;
+
+  SampleArena(int size)
+      : _ptr = calloc<Uint8>(size),
+        _size = size;
+
+  int get size => _size;
+
+  bool get isDisposed => _ptr.address == 0;
+
+  /// The arena contents as seen from Dart
+  Uint8List get bytes => _ptr.asTypedList(_size);
+
+  void _grow() {
+    calloc.free(_ptr);
+    _size *= 2;
+    _ptr = calloc<Uint8>(_size);
+  }
+
+  void dispose() {
+    if (isDisposed) return;
+    calloc.free(_ptr);
+    _ptr = nullptr;
+  }
+}
+
+/// A subscriber whose samples are queued natively and drained in bulk.
+class PullSubscriber {
+  final String key;
+  final int id;
+  final SampleArena _arena;
+  bool _closed = false;
+
+  PullSubscriber._(this.key, this.id, int arenaSize)
+      : _arena = SampleArena(arenaSize);
+
+  bool get isClosed => _closed;
+
+  /// Drain up to [max] queued samples into the subscriber's own arena
+  List<DrainedSample> drain({int max = 1024}) => drainInto(_arena, max: max);
+
+  /// Drain up to [max] queued samples into [arena] in a single FFI call.
+  ///
+  /// The arena is grown if the next sample does not fit in it at all.
+  List<DrainedSample> drainInto(SampleArena arena, {int max = 1024}) {
+    if (_closed || arena.isDisposed) return const [];
+
+    var count = ZenohDart._bindings
+        .zenoh_subscriber_drain(id, arena._ptr, arena._size, max);
+    while (count == -7) {
+      arena._grow();
+      count = ZenohDart._bindings
+          .zenoh_subscriber_drain(id, arena._ptr, arena._size, max);
+    }
+    if (count < 0) {
+      throw Exception('Failed to drain subscriber $id, error: $count');
+    }
+    return _decodeSampleRecords(arena._ptr.asTypedList(arena._size), count);
+  }
+
+  /// Drain every [interval] and emit each non-empty batch.
+  ///
+  /// Meant for coalescing subscribers from [ZenohDart.subscribeLatest], where
+  /// a batch holds one sample per key updated since the previous tick. The
+  /// batch is delivered synchronously and its payloads are views into the
+  /// subscriber's arena, valid until the next tick.
+  Stream<List<DrainedSample>> snapshots(Duration interval, {int max = 1024}) {
+    Timer? timer;
+    late final StreamController<List<DrainedSample>> controller;
+    controller = StreamController<List<DrainedSample>>(
+      sync: true,
+      onListen: () {
+        timer = Timer.periodic(interval, (_) {
+          if (_closed) {
+            timer?.cancel();
+            controller.close();
+            return;
+          }
+          if (controller.isPaused) return;
+          final batch = drain(max: max);
+          if (batch.isNotEmpty) controller.add(batch);
+        });
+      },
+      onCancel: () => timer?.cancel(),
+    );
+    return controller.stream;
+  }
+
+  /// Unsubscribe and free the subscriber's own arena
+  void close() {
+    if (_closed) return;
+    ZenohDart.unsubscribe(id);
+    _arena.dispose();
+    _closed = true;
+  }
+}
+
+/// Handler run inside a worker isolate of [ZenohDart.subscribeIsolatePool]
+typedef IsolateSampleHandler = void Function(DrainedSample sample);
+
+/// A subscriber whose samples are sharded across worker isolates by key.
+///
+/// The native layer picks the worker from a hash of the sample key, so all
+/// samples of one key are handled by the same isolate in arrival order while
+/// different keys are decoded and processed in parallel, off the UI isolate.
+class IsolatePoolSubscriber {
+  final String key;
+  final int id;
+  final List<Isolate> _workers;
+  bool _closed = false;
+
+  IsolatePoolSubscriber._(this.key, this.id, this._workers);
+
+  int get isolateCount => _workers.length;
+
+  bool get isClosed => _closed;
+
+  /// Unsubscribe and shut the worker isolates down
+  void close() {
+    if (_closed) return;
+    ZenohDart.unsubscribe(id);
+    for (final worker in _workers) {
+      worker.kill();
+    }
+    _closed = true;
+  }
+}
+
+/// Entry point of an [IsolatePoolSubscriber] worker, hands its port back
+void _isolatePoolWorker((SendPort, IsolateSampleHandler) setup) {
+  final (readyPort, handler) = setup;
+  final port = RawReceivePort((Object? message) {
+    handler(DrainedSample.fromMessage(message as Uint8List));
+  }, 'zenoh worker');
+  readyPort.send(port.sendPort);
+}
+
+/// Decode [count] sample_record_t entries written by zenoh_subscriber_drain
+/// or posted by a port subscriber
+List<DrainedSample> _decodeSampleRecords(Uint8List bytes, int count) {
+  final header = ByteData.sublistView(bytes);
+  final headerSize = sizeOf<sample_record_t>();
+  final samples = <DrainedSample>[];
+  var offset = 0;
+  for (var i = 0; i < count; i++) {
+    // sample_record_t: size, key_len, payload_len, kind, timestamp,
+    // attachment_len
+    final size = header.getUint32(offset, Endian.host);
+    final keyLen = header.getUint32(offset + 4, Endian.host);
+    final payloadLen = header.getUint32(offset + 8, Endian.host);
+    final attachmentLen = header.getUint32(offset + 24, Endian.host);
+    final keyStart = offset + headerSize;
+    final payloadStart = keyStart + keyLen;
+    final attachmentStart = payloadStart + payloadLen;
+    samples.add(DrainedSample._(
+      // Copied, key decodes lazily and may outlive the arena contents
+      bytes.sublist(keyStart, payloadStart),
+      Uint8List.sublistView(bytes, payloadStart, attachmentStart),
+      attachmentLen == 0
+          ? null
+          : Uint8List.sublistView(
+              bytes, attachmentStart, attachmentStart + attachmentLen),
+      header.getUint32(offset + 12, Endian.host),
+      header.getUint64(offset + 16, Endian.host),
+    ));
+    offset += size;
+  }
+  return samples;
+}
+
+/// Reply side of a [ZenohQuery], plain data so it can be sent to another
+/// isolate that answers the query.
+///
+/// Must not be used once the query has been released.
+class QueryReplier {
+  final int address;
+
+  const QueryReplier._(this.address);
+
+  /// Send [data] as a reply, may be called several times before [release]
+  int reply(Uint8List data, {String? encoding, Uint8List? attachment}) {
+    final dataPtr = calloc<Uint8>(data.isEmpty ? 1 : data.length);
+    dataPtr.asTypedList(data.length).setAll(0, data);
+    final encodingPtr =
+        encoding == null ? nullptr : encoding.toNativeUtf8().cast<Char>();
+    final attachmentPtr = _nativeCopy(attachment);
+
+    final result = ZenohDart._bindings.zenoh_query_reply(
+        Pointer<Void>.fromAddress(address),
+        dataPtr,
+        data.length,
+        encodingPtr,
+        attachmentPtr,
+        attachment?.length ?? 0);
+
+    calloc.free(dataPtr);
+    if (encodingPtr != nullptr) calloc.free(encodingPtr);
+    if (attachmentPtr != nullptr) calloc.free(attachmentPtr);
+    return result;
+  }
+
+  /// Send a UTF-8 string as a reply
+  int replyString(String value, {String? encoding, Uint8List? attachment}) =>
+      reply(utf8.encode(value), encoding: encoding, attachment: attachment);
+
+  /// Drop the native query, which tells the querier no more replies follow
+  void release() {
+    ZenohDart._bindings.zenoh_query_release(Pointer<Void>.fromAddress(address));
+  }
+}
+
+/// A query received by a [Queryable].
+///
+/// The native query stays alive until [release], so replies can be sent
+/// later, from this isolate or through [replier] from another one.
+class ZenohQuery {
+  final String key;
+  final String parameters;
+
+  /// View into native memory, valid until [release] for callback queryables
+  /// and until the next drain for ring queryables
+  final Uint8List payload;
+
+  /// View like [payload], null when the query carries no attachment
+  final Uint8List? attachment;
+  final int queryableHandle;
+  Pointer<Void> _handle;
+
+  ZenohQuery._(this.key, this.parameters, this.payload, this.attachment,
+      this.queryableHandle, this._handle);
+
+  bool get isReleased => _handle.address == 0;
+
+  QueryReplier get replier => QueryReplier._(_handle.address);
+
+  String get payloadString => utf8.decode(payload, allowMalformed: true);
+
+  int reply(Uint8List data, {String? encoding, Uint8List? attachment}) {
+    if (isReleased) return -1;
+    return replier.reply(data, encoding: encoding, attachment: attachment);
+  }
+
+  int replyString(String value, {String? encoding, Uint8List? attachment}) =>
+      reply(utf8.encode(value), encoding: encoding, attachment: attachment);
+
+  /// Finish the query, no replies can be sent afterwards
+  void release() {
+    if (isReleased) return;
+    ZenohDart._bindings.zenoh_query_release(_handle);
+    _handle = nullptr;
+  }
+}
+
+/// A queryable declared through [ZenohDart.declareQueryable].
+class Queryable {
+  final String key;
+  final int handle;
+
+  /// QUERYABLE_MODE_CALLBACK or QUERYABLE_MODE_RING
+  final int mode;
+
+  /// Drain buffer, ring queryables only
+  final SampleArena? _arena;
+  bool _declared = true;
+
+  Queryable._(this.key, this.handle, this.mode, this._arena);
+
+  bool get isDeclared => _declared;
+
+  /// Take up to [max] queued queries of a ring queryable in one FFI call.
+  ///
+  /// Each returned query must be released once answered.
+  List<ZenohQuery> drain({int max = 256}) {
+    final arena = _arena;
+    if (!_declared || arena == null) return const [];
+
+    var count = ZenohDart._bindings
+        .zenoh_queryable_drain(handle, arena._ptr, arena._size, max);
+    while (count == -7) {
+      arena._grow();
+      count = ZenohDart._bindings
+          .zenoh_queryable_drain(handle, arena._ptr, arena._size, max);
+    }
+    if (count < 0) {
+      throw Exception('Failed to drain queryable $handle, error: $count');
+    }
+
+    final bytes = arena._ptr.asTypedList(arena._size);
+    final headerSize = sizeOf<query_record_t>();
+    final queries = <ZenohQuery>[];
+    var offset = 0;
+    for (var i = 0; i < count; i++) {
+      final record = (arena._ptr + offset).cast<query_record_t>().ref;
+      final keyStart = offset + headerSize;
+      final parametersStart = keyStart + record.key_len;
+      final payloadStart = parametersStart + record.parameters_len;
+      final attachmentStart = payloadStart + record.payload_len;
+      queries.add(ZenohQuery._(
+        utf8.decode(Uint8List.sublistView(bytes, keyStart, parametersStart),
+            allowMalformed: true),
+        utf8.decode(
+            Uint8List.sublistView(bytes, parametersStart, payloadStart),
+            allowMalformed: true),
+        Uint8List.sublistView(bytes, payloadStart, attachmentStart),
+        record.attachment_len == 0
+            ? null
+            : Uint8List.sublistView(bytes, attachmentStart,
+                attachmentStart + record.attachment_len),
+        handle,
+        Pointer<Void>.fromAddress(record.query_handle),
+      ));
+      offset += record.size;
+    }
+    return queries;
+  }
+
+  /// Undeclare the queryable and free its slot
+  void undeclare() {
+    if (!_declared) return;
+    ZenohDart._activeQueryables.remove(handle);
+    ZenohDart._bindings.zenoh_undeclare_queryable(handle);
+    _arena?.dispose();
+    _declared = false;
+  }
+}
+
+/// Which queryables a query is routed to, mirrors z_query_target_t
+enum QueryTarget {
+  bestMatching(0),
+  all(1),
+  allComplete(2);
+
+  final int value;
+  const QueryTarget(this.value);
+}
+
+/// How replies to a query are consolidated, mirrors z_consolidation_mode_t
+enum ConsolidationMode {
+  auto(-1),
+  none(0),
+  monotonic(1),
+  latest(2);
+
+  final int value;
+  const ConsolidationMode(this.value);
+}
+
+/// A querier declared once for repeated gets on the same key.
+class Querier {
+  final String key;
+  final int handle;
+  bool _declared = true;
+
+  Querier._(this.key, this.handle);
+
+  bool get isDeclared => _declared;
+
+  /// Send a query and stream its replies, like [ZenohDart.getReplies]
+  Stream<ZenohReply> get(
+      {String parameters = '', Uint8List? payload, Uint8List? attachment}) {
+    if (!_declared) {
+      throw StateError('Querier for $key has been undeclared');
+    }
+
+    return ZenohDart._startGet(key, (requestId) {
+      final parametersPtr = parameters.toNativeUtf8().cast<Char>();
+      final payloadPtr = payload == null
+          ? nullptr
+          : calloc<Uint8>(payload.isEmpty ? 1 : payload.length);
+      if (payload != null) {
+        payloadPtr.asTypedList(payload.length).setAll(0, payload);
+      }
+      final attachmentPtr = _nativeCopy(attachment);
+
+      final result = ZenohDart._bindings.zenoh_querier_get(
+        handle,
+        parametersPtr,
+        payloadPtr,
+        payload?.length ?? 0,
+        attachmentPtr,
+        attachment?.length ?? 0,
+        ZenohDart._nativeReplyCallable!.nativeFunction,
+        requestId,
+      );
+
+      calloc.free(parametersPtr);
+      if (payloadPtr != nullptr) calloc.free(payloadPtr);
+      if (attachmentPtr != nullptr) calloc.free(attachmentPtr);
+      return result;
+    });
+  }
+
+  /// Undeclare the querier and free its slot
+  void undeclare() {
+    if (!_declared) return;
+    ZenohDart._bindings.zenoh_undeclare_querier(handle);
+    _declared = false;
+  }
+}
+
+/// Copy optional bytes into a new calloc block, nullptr for null
+Pointer<Uint8> _nativeCopy(Uint8List? bytes) {
+  if (bytes == null) return nullptr;
+  final ptr = calloc<Uint8>(bytes.isEmpty ? 1 : bytes.length);
+  ptr.asTypedList(bytes.length).setAll(0, bytes);
+  return ptr;
+}
+
+/// Reusable native staging buffer, so hot calls copy their arguments once
+/// without allocating
+class _NativeScratch {
+  Pointer<Uint8> _ptr = nullptr;
+  int _capacity = 0;
+
+  /// A buffer of at least [size] bytes, valid until the next reserve
+  Pointer<Uint8> reserve(int size) {
+    if (_ptr == nullptr || size > _capacity) {
+      if (_ptr != nullptr) calloc.free(_ptr);
+      var capacity = _capacity == 0 ? 256 : _capacity;
+      while (capacity < size) {
+        capacity *= 2;
+      }
+      _ptr = calloc<Uint8>(capacity);
+      _capacity = capacity;
+    }
+    return _ptr;
+  }
+}
+
+class _PendingGet {
+  final StreamController<ZenohReply> controller;
+  bool cancelled = false;
+
+  _PendingGet(this.controller);
+}
+
+/// Routing priority of published data, mirrors z_priority_t
+enum Priority {
+  realTime(1),
+  interactiveHigh(2),
+  interactiveLow(3),
+  dataHigh(4),
+  data(5),
+  dataLow(6),
+  background(7);
+
+  final int value;
+  const Priority(this.value);
+}
+
+/// What to do when the outgoing queue is full, mirrors z_congestion_control_t
+enum CongestionControl {
+  block(0),
+  drop(1);
+
+  final int value;
+  const CongestionControl(this.value);
+}
+
+/// Reliability marker of published data, mirrors z_reliability_t.
+///
+/// Only honoured by builds with the unstable zenoh API enabled.
+enum Reliability {
+  bestEffort(0),
+  reliable(1);
+
+  final int value;
+  const Reliability(this.value);
+}
+
+/// QoS and encoding for a publisher or a single put; null fields keep the
+/// zenoh defaults.
+///
+/// Control-loop commands typically want [Priority.realTime] with
+/// [express] set, bulk logs [Priority.background] with
+/// [CongestionControl.drop].
+class PublisherOptions {
+  final String? encoding;
+  final Priority? priority;
+  final CongestionControl? congestionControl;
+
+  /// Send immediately instead of batching with other messages
+  final bool? express;
+  final Reliability? reliability;
+
+  const PublisherOptions({
+    this.encoding,
+    this.priority,
+    this.congestionControl,
+    this.express,
+    this.reliability,
+  });
+
+  /// Allocate the native mirror, free it with [_freeNative]
+  Pointer<publisher_options_t> _toNative() {
+    final native = calloc<publisher_options_t>();
+    native.ref.encoding =
+        encoding == null ? nullptr : encoding!.toNativeUtf8().cast<Char>();
+    native.ref.priority = priority?.value ?? ZENOH_OPTION_DEFAULT;
+    native.ref.congestion_control =
+        congestionControl?.value ?? ZENOH_OPTION_DEFAULT;
+    native.ref.is_express =
+        express == null ? ZENOH_OPTION_DEFAULT : (express! ? 1 : 0);
+    native.ref.reliability = reliability?.value ?? ZENOH_OPTION_DEFAULT;
+    return native;
+  }
+
+  static void _freeNative(Pointer<publisher_options_t> native) {
+    if (native.ref.encoding != nullptr) calloc.free(native.ref.encoding);
+    calloc.free(native);
+  }
+}
+
+/// A writable native buffer from [ZenohDart.allocShm], published without a
+/// copy through [Publisher.putShm].
+///
+/// Backed by zenoh shared memory when the plugin is built with it, so local
+/// subscribers map the same pages; otherwise by a heap block handed over to
+/// zenoh as is from the plugin buffer pool. Fill [data], then publish or [free]
+/// it exactly once.
+class ShmBuffer {
+  Pointer<Void> _handle;
+
+  /// The buffer contents, must not be touched once consumed
+  final Uint8List data;
+
+  ShmBuffer._(this._handle, this.data);
+
+  bool get isConsumed => _handle.address == 0;
+
+  Pointer<Void> _take() {
+    final handle = _handle;
+    _handle = nullptr;
+    return handle;
+  }
+
+  /// Discard the buffer without publishing it
+  void free() {
+    if (isConsumed) return;
+    ZenohDart._bindings.zenoh_shm_free(_take());
+  }
+}
+
+/// A native buffer from [ZenohDart.allocBuffer], published without a copy
+/// through [Publisher.putBuffer].
+///
+/// The plugin keeps released buffers in size-class free lists, so a steady
+/// stream of large payloads reuses the same few blocks instead of hitting the
+/// allocator. Fill [data], then publish or [free] it exactly once.
+class PooledBuffer {
+  Pointer<Uint8> _ptr;
+
+  /// The buffer contents, must not be touched once consumed
+  final Uint8List data;
+
+  PooledBuffer._(this._ptr, this.data);
+
+  bool get isConsumed => _ptr.address == 0;
+
+  Pointer<Uint8> _take() {
+    final ptr = _ptr;
+    _ptr = nullptr;
+    return ptr;
+  }
+
+  /// Return the buffer to the pool without publishing it
+  void free() {
+    if (isConsumed) return;
+    ZenohDart._bindings.zenoh_buffer_free(_take());
+  }
+}
+
+/// A publisher declared once and kept warm for repeated puts on one key.
+class Publisher {
+  final String key;
+  final int handle;
+  bool _declared = true;
+
+  Publisher._(this.key, this.handle);
+
+  bool get isDeclared => _declared;
+
+  /// Publish raw bytes, copied once into a reused native buffer along with
+  /// the optional [attachment]
+  int put(Uint8List data, {Uint8List? attachment}) {
+    if (!_declared) return -1;
+    final attachmentLen = attachment?.length ?? 0;
+    final dataPtr = ZenohDart._scratch.reserve(data.length + attachmentLen);
+    final staged = dataPtr.asTypedList(data.length + attachmentLen);
+    staged.setAll(0, data);
+    if (attachment != null) staged.setAll(data.length, attachment);
+    return ZenohDart._bindings.zenoh_publisher_put(handle, dataPtr, data.length,
+        attachment == null ? nullptr : dataPtr + data.length, attachmentLen);
+  }
+
+  /// Publish a UTF-8 string
+  int putString(String value, {Uint8List? attachment}) =>
+      put(utf8.encode(value), attachment: attachment);
+
+  /// Publish [buffer] without copying it; the buffer is consumed either way
+  int putShm(ShmBuffer buffer) {
+    if (buffer.isConsumed) return -3;
+    if (!_declared) {
+      buffer.free();
+      return -1;
+    }
+    return ZenohDart._bindings.zenoh_publish_shm(handle, buffer._take());
+  }
+
+  /// Publish the first [length] bytes of [buffer] (all of it by default)
+  /// without copying; the buffer is consumed either way
+  int putBuffer(PooledBuffer buffer, {int? length}) {
+    if (buffer.isConsumed) return -3;
+    if (!_declared) {
+      buffer.free();
+      return -1;
+    }
+    final len = length ?? buffer.data.length;
+    if (len < 0 || len > buffer.data.length) {
+      buffer.free();
+      return -3;
+    }
+    return ZenohDart._bindings.zenoh_publish_buffer(handle, buffer._take(), len);
+  }
+
+  /// Publish all [payloads] in a single FFI call.
+  ///
+  /// Returns the number of payloads published, or a negative error code.
+  int putAll(List<Uint8List> payloads) {
+    if (!_declared) return -1;
+    if (payloads.isEmpty) return 0;
+
+    var total = 0;
+    for (final payload in payloads) {
+      total += payload.length;
+    }
+
+    // One arena for every payload plus count + 1 boundary offsets
+    final bufPtr = calloc<Uint8>(total == 0 ? 1 : total);
+    final offsetsPtr = calloc<Uint32>(payloads.length + 1);
+    final buf = bufPtr.asTypedList(total);
+    final offsets = offsetsPtr.asTypedList(payloads.length + 1);
+
+    var position = 0;
+    for (var i = 0; i < payloads.length; i++) {
+      offsets[i] = position;
+      buf.setAll(position, payloads[i]);
+      position += payloads[i].length;
+    }
+    offsets[payloads.length] = position;
+
+    final result = ZenohDart._bindings
+        .zenoh_publish_batch(handle, bufPtr, offsetsPtr, payloads.length);
+
+    calloc.free(bufPtr);
+    calloc.free(offsetsPtr);
+    return result;
+  }
+
+  /// Undeclare the publisher and free its slot
+  void undeclare() {
+    if (!_declared) return;
+    ZenohDart._bindings.zenoh_undeclare_publisher(handle);
+    _declared = false;
+  }
+}
 
 class ZenohDart {
   static final ZenohDartBindings _bindings = ZenohDartBindings(_dylib);
 
+  // Staging buffer for binary puts
+  static final _NativeScratch _scratch = _NativeScratch();
+
+  // zenoh_sample_release as a native finalizer for sample handles
+  static final Pointer<NativeFinalizerFunction> _sampleReleasePtr =
+      _dylib.lookup<NativeFinalizerFunction>('zenoh_sample_release');
+
   // Store active subscribers with their callbacks
   static final Map<int, DartSubscriberCallback> _activeSubscribers = {};
+  static final Map<int, DartSubscriberBytesCallback> _activeBytesSubscribers =
+      {};
 
   // Use a single NativeCallable that stays alive for the app lifetime
   static NativeCallable<SubscriberCallbackFunction>? _nativeCallable;
+  static NativeCallable<SubscriberBytesCallbackFunction>? _nativeBytesCallable;
+
+  // Callback-mode queryables keyed by handle
+  static final Map<int, DartQueryCallback> _activeQueryables = {};
+  static NativeCallable<QueryCallbackFunction>? _nativeQueryCallable;
+
+  // In-flight async gets keyed by request id
+  static final Map<int, _PendingGet> _pendingGets = {};
+  static int _nextRequestId = 0;
+  static NativeCallable<GetReplyCallbackFunction>? _nativeReplyCallable;
+
+  // Completed by the last DONE marker while cleanup waits for in-flight gets
+  static Completer<void>? _getsDrained;
   static bool _isInitialized = false;
 
   /// Initialize Zenoh session and callback
@@ -39,6 +920,19 @@ class ZenohDart {
     _nativeCallable = NativeCallable<SubscriberCallbackFunction>.listener(
       _globalCallback,
     );
+    _nativeBytesCallable =
+        NativeCallable<SubscriberBytesCallbackFunction>.listener(
+      _globalBytesCallback,
+    );
+    _nativeReplyCallable = NativeCallable<GetReplyCallbackFunction>.listener(
+      _globalReplyCallback,
+    );
+    _nativeQueryCallable = NativeCallable<QueryCallbackFunction>.listener(
+      _globalQueryCallback,
+    );
+
+    // Lets port subscribers post samples without going through a callback
+    _bindings.zenoh_init_dart_api(NativeApi.postCObject.cast());
 
     _isInitialized = true;
     print('ZenohDart: Initialized successfully');
@@ -47,49 +941,46 @@ class ZenohDart {
   /// Global callback that dispatches to registered Dart callbacks
   static void _globalCallback(
     Pointer<Char> key,
+    int keyId,
     Pointer<Char> value,
-    Pointer<Char> kind,
-    Pointer<Char> attachment,
+    int kind,
+    Pointer<Uint8> attachment,
+    int attachmentLen,
     int subscriberId,
   ) {
-    // These pointers are malloc'd on C side and we OWN them
-    // We MUST free them after copying to Dart strings
+    // value heads a native slab block we OWN and MUST release after copying;
+    // key is interned natively when keyId >= 0, otherwise it is in the block
 
-    String? keyStr;
-    String? valueStr;
-    String? kindStr;
-    String? attachmentStr;
+    var released = false;
 
     try {
       // Check if we have a callback registered for this subscriber
       final callback = _activeSubscribers[subscriberId];
       if (callback == null) {
-        // Free the strings even if no callback
-        _freeCallbackStrings(key, value, kind, attachment);
+        // Free the block even if no callback
+        _freeCallbackStrings(value);
         return;
       }
 
       // Validate pointers
-      if (key.address == 0 ||
-          value.address == 0 ||
-          kind.address == 0 ||
-          attachment.address == 0) {
+      if (key.address == 0 || value.address == 0) {
         print(
             'Warning: Received null pointer in callback for subscriber $subscriberId');
-        _freeCallbackStrings(key, value, kind, attachment);
+        _freeCallbackStrings(value);
         return;
       }
 
-      // Copy strings from C memory to Dart strings
-      // This must succeed before we free the C strings
+      // Interned keys are decoded once and reused for every later sample
+      final String keyStr;
       try {
-        keyStr = key.cast<Utf8>().toDartString();
+        keyStr = keyId >= 0 ? _internedKey(keyId, key) : _decodeKey(key);
       } catch (e) {
         print('Error decoding key: $e');
-        _freeCallbackStrings(key, value, kind, attachment);
+        _freeCallbackStrings(value);
         return;
       }
 
+      String valueStr;
       try {
         valueStr = value.cast<Utf8>().toDartString();
       } catch (e) {
@@ -97,52 +988,188 @@ class ZenohDart {
         valueStr = '<decode error>';
       }
 
-      try {
-        kindStr = kind.cast<Utf8>().toDartString();
-      } catch (e) {
-        print('Error decoding kind: $e');
-        kindStr = 'UNKNOWN';
-      }
-
-      try {
-        attachmentStr = attachment.cast<Utf8>().toDartString();
-      } catch (e) {
-        attachmentStr = '';
-      }
+      // Copied so the slab block goes back right away instead of staying
+      // pinned for as long as the attachment is reachable
+      final attachmentBytes = attachment.address == 0
+          ? null
+          : Uint8List.fromList(attachment.asTypedList(attachmentLen));
 
-      // Free C strings BEFORE calling Dart callback
+      // Free the block BEFORE calling Dart callback
       // Now the strings are safely copied to Dart
-      _freeCallbackStrings(key, value, kind, attachment);
+      _freeCallbackStrings(value);
+      released = true;
 
       // Now call the Dart callback with our Dart strings
-      callback(keyStr, valueStr, kindStr, attachmentStr, subscriberId);
+      callback(keyStr, valueStr, _sampleKindName(kind), attachmentBytes,
+          subscriberId);
     } catch (e) {
       print('Error in global callback: $e');
-      // Make sure we free even on error
-      try {
-        _freeCallbackStrings(key, value, kind, attachment);
-      } catch (_) {}
+      // Make sure we free even on error, but never return a block twice
+      if (!released) {
+        try {
+          _freeCallbackStrings(value);
+        } catch (_) {}
+      }
+    }
+  }
+
+  /// Dart copies of the native interned keys, indexed by key id
+  static final List<String?> _internedKeys = [];
+
+  static String _decodeKey(Pointer<Char> key) =>
+      key.cast<Utf8>().toDartString();
+
+  static String _internedKey(int keyId, Pointer<Char> key) {
+    if (keyId >= _internedKeys.length) {
+      _internedKeys.length = keyId + 1;
     }
+    return _internedKeys[keyId] ??= _decodeKey(key);
   }
 
-  /// Helper to free C strings passed to callback
-  static void _freeCallbackStrings(
+  static String _sampleKindName(int kind) => switch (kind) {
+        0 => 'PUT',
+        1 => 'DELETE',
+        _ => 'UNKNOWN',
+      };
+
+  /// Global binary callback - wraps the native view without copying
+  static void _globalBytesCallback(
     Pointer<Char> key,
-    Pointer<Char> value,
-    Pointer<Char> kind,
-    Pointer<Char> attachment,
+    int keyLen,
+    Pointer<Uint8> payload,
+    int payloadLen,
+    Pointer<Uint8> attachment,
+    int attachmentLen,
+    int kind,
+    int isShm,
+    Pointer<Void> handle,
+    int subscriberId,
   ) {
+    final callback = _activeBytesSubscribers[subscriberId];
+    if (callback == null) {
+      _bindings.zenoh_sample_release(handle);
+      return;
+    }
+
     try {
-      if (key.address != 0) calloc.free(key);
-      if (value.address != 0) calloc.free(value);
-      if (kind.address != 0) calloc.free(kind);
-      // Attachment is usually empty string "", don't free it
-      // if (attachment.address != 0) calloc.free(attachment);
+      // The key is copied as bytes, decoding is left to Sample.key
+      final keyBytes =
+          Uint8List.fromList(key.cast<Uint8>().asTypedList(keyLen));
+      var view = Uint8List(0);
+      if (payloadLen > 0) {
+        // The view holds its own reference so it can never outlive the sample
+        _bindings.zenoh_sample_retain(handle);
+        view = payload.asTypedList(payloadLen,
+            finalizer: _sampleReleasePtr, token: handle);
+      }
+      Uint8List? attachmentView;
+      if (attachment.address != 0) {
+        attachmentView = Uint8List(0);
+        if (attachmentLen > 0) {
+          // Same convention as the payload view
+          _bindings.zenoh_sample_retain(handle);
+          attachmentView = attachment.asTypedList(attachmentLen,
+              finalizer: _sampleReleasePtr, token: handle);
+        }
+      }
+      final sample = ZenohSample._(
+        keyBytes,
+        view,
+        attachmentView,
+        kind,
+        isShm != 0,
+        subscriberId,
+        handle,
+      );
+      callback(sample);
+    } catch (e) {
+      print('Error in global bytes callback: $e');
+    }
+  }
+
+  /// Global query callback - hands each query to its queryable's callback
+  static void _globalQueryCallback(
+    int queryableHandle,
+    Pointer<Char> key,
+    int keyLen,
+    Pointer<Char> parameters,
+    int parametersLen,
+    Pointer<Uint8> payload,
+    int payloadLen,
+    Pointer<Uint8> attachment,
+    int attachmentLen,
+    Pointer<Void> handle,
+  ) {
+    final callback = _activeQueryables[queryableHandle];
+    if (callback == null) {
+      _bindings.zenoh_query_release(handle);
+      return;
+    }
+
+    try {
+      final query = ZenohQuery._(
+        key.cast<Utf8>().toDartString(length: keyLen),
+        parameters.cast<Utf8>().toDartString(length: parametersLen),
+        payloadLen == 0 ? Uint8List(0) : payload.asTypedList(payloadLen),
+        attachment.address == 0 ? null : attachment.asTypedList(attachmentLen),
+        queryableHandle,
+        handle,
+      );
+      callback(query);
     } catch (e) {
-      print('Error freeing callback strings: $e');
+      print('Error in global query callback: $e');
     }
   }
 
+  /// Global reply callback - routes async get replies to their stream
+  static void _globalReplyCallback(
+    int requestId,
+    int status,
+    Pointer<Char> key,
+    int keyLen,
+    Pointer<Uint8> payload,
+    int payloadLen,
+    Pointer<Uint8> attachment,
+    int attachmentLen,
+    Pointer<Void> handle,
+  ) {
+    final pending = _pendingGets[requestId];
+
+    if (status == ZENOH_REPLY_DONE) {
+      _pendingGets.remove(requestId);
+      pending?.controller.close();
+      final drained = _getsDrained;
+      if (_pendingGets.isEmpty && drained != null && !drained.isCompleted) {
+        drained.complete();
+      }
+      return;
+    }
+
+    if (pending == null || pending.cancelled) {
+      _bindings.zenoh_sample_release(handle);
+      return;
+    }
+
+    try {
+      pending.controller.add(ZenohReply._(
+        keyLen == 0 ? '' : key.cast<Utf8>().toDartString(length: keyLen),
+        payloadLen == 0 ? Uint8List(0) : payload.asTypedList(payloadLen),
+        attachment.address == 0 ? null : attachment.asTypedList(attachmentLen),
+        status == ZENOH_REPLY_ERROR,
+        handle,
+      ));
+    } catch (e) {
+      print('Error in global reply callback: $e');
+      _bindings.zenoh_sample_release(handle);
+    }
+  }
+
+  /// Hand the callback block headed by [value] back to the native slab;
+  /// interned keys are not part of it
+  static void _freeCallbackStrings(Pointer<Char> value) {
+    if (value.address != 0) _bindings.zenoh_release(value.cast());
+  }
+
   /// Subscribe to a Zenoh key expression
   static Future<int> subscribe(
       String key, DartSubscriberCallback callback) async {
@@ -175,11 +1202,198 @@ class ZenohDart {
     }
   }
 
+  /// Subscribe to a Zenoh key expression, receiving raw payload bytes.
+  ///
+  /// Each [ZenohSample] must be released with [ZenohSample.release].
+  static Future<int> subscribeBytes(
+      String key, DartSubscriberBytesCallback callback) async {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
+    final keyPtr = key.toNativeUtf8().cast<Char>();
+    final subscriberId = _bindings.zenoh_subscribe_bytes(
+      keyPtr,
+      _nativeBytesCallable!.nativeFunction,
+    );
+    calloc.free(keyPtr);
+
+    if (subscriberId < 0) {
+      throw Exception('Failed to subscribe to $key, error: $subscriberId');
+    }
+
+    _activeBytesSubscribers[subscriberId] = callback;
+    print('ZenohDart: Subscribed (bytes) to "$key" with ID: $subscriberId');
+    return subscriberId;
+  }
+
+  /// Subscribe to [key] with a native ring of [capacity] samples.
+  ///
+  /// Nothing is delivered to Dart until [PullSubscriber.drain] is called.
+  /// Under bursts the oldest samples are dropped, so memory stays flat.
+  static PullSubscriber subscribeRing(String key,
+      {int capacity = 256, int arenaSize = 64 * 1024}) {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
+    final keyPtr = key.toNativeUtf8().cast<Char>();
+    final subscriberId = _bindings.zenoh_subscribe_ring(keyPtr, capacity);
+    calloc.free(keyPtr);
+
+    if (subscriberId < 0) {
+      throw Exception('Failed to subscribe to $key, error: $subscriberId');
+    }
+
+    print('ZenohDart: Subscribed (ring) to "$key" with ID: $subscriberId');
+    return PullSubscriber._(key, subscriberId, arenaSize);
+  }
+
+  /// Subscribe to [key] with a native FIFO of [capacity] samples.
+  ///
+  /// Every sample is kept until drained with [PullSubscriber.drain] or
+  /// [PullSubscriber.drainInto]; once [capacity] samples are pending the
+  /// network side is slowed down instead of dropping data.
+  static PullSubscriber subscribeFifo(String key,
+      {int capacity = 1024, int arenaSize = 64 * 1024}) {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
+    final keyPtr = key.toNativeUtf8().cast<Char>();
+    final subscriberId = _bindings.zenoh_subscribe_fifo(keyPtr, capacity);
+    calloc.free(keyPtr);
+
+    if (subscriberId < 0) {
+      throw Exception('Failed to subscribe to $key, error: $subscriberId');
+    }
+
+    print('ZenohDart: Subscribed (fifo) to "$key" with ID: $subscriberId');
+    return PullSubscriber._(key, subscriberId, arenaSize);
+  }
+
+  /// Subscribe to [key] keeping only the newest sample of each matching key.
+  ///
+  /// Updates are collapsed natively, so each [PullSubscriber.drain] returns at
+  /// most one sample per key changed since the previous drain; poll it at a
+  /// fixed rate or use [PullSubscriber.snapshots]. [capacity] is the expected
+  /// number of distinct keys, the native map grows past it if needed.
+  static PullSubscriber subscribeLatest(String key,
+      {int capacity = 64, int arenaSize = 64 * 1024}) {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
+    final keyPtr = key.toNativeUtf8().cast<Char>();
+    final subscriberId = _bindings.zenoh_subscribe_latest(keyPtr, capacity);
+    calloc.free(keyPtr);
+
+    if (subscriberId < 0) {
+      throw Exception('Failed to subscribe to $key, error: $subscriberId');
+    }
+
+    print('ZenohDart: Subscribed (latest) to "$key" with ID: $subscriberId');
+    return PullSubscriber._(key, subscriberId, arenaSize);
+  }
+
+  /// Subscribe to [key] with samples posted to a new [ReceivePort] of the
+  /// calling isolate, exposed as [PortSubscriber.samples].
+  static PortSubscriber subscribePort(String key) {
+    final port = ReceivePort('zenoh:$key');
+    try {
+      final subscriberId = subscribeToPort(key, port.sendPort);
+      return PortSubscriber._(key, subscriberId, port);
+    } catch (_) {
+      port.close();
+      rethrow;
+    }
+  }
+
+  /// Subscribe to [key] with samples posted to [sendPort], which may belong
+  /// to a background isolate.
+  ///
+  /// Each message is a [Uint8List] to decode with [DrainedSample.fromMessage]
+  /// in the receiving isolate. Returns the subscriber id for [unsubscribe].
+  static int subscribeToPort(String key, SendPort sendPort) {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
+    final keyPtr = key.toNativeUtf8().cast<Char>();
+    final subscriberId =
+        _bindings.zenoh_subscribe_port(keyPtr, sendPort.nativePort);
+    calloc.free(keyPtr);
+
+    if (subscriberId < 0) {
+      throw Exception('Failed to subscribe to $key, error: $subscriberId');
+    }
+
+    print('ZenohDart: Subscribed (port) to "$key" with ID: $subscriberId');
+    return subscriberId;
+  }
+
+  /// Subscribe to [key] with samples handled by [isolatePool] worker isolates.
+  ///
+  /// Each sample runs [handler] in the worker its key hashes to, so per-key
+  /// order is preserved. [handler] is sent to every worker and must therefore
+  /// be sendable, e.g. a top-level or static function.
+  static Future<IsolatePoolSubscriber> subscribeIsolatePool(
+      String key, IsolateSampleHandler handler,
+      {int? isolatePool}) async {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
+    final count = isolatePool ??
+        (Platform.numberOfProcessors - 1).clamp(1, MAX_PORT_SHARDS);
+    if (count < 1 || count > MAX_PORT_SHARDS) {
+      throw ArgumentError.value(
+          isolatePool, 'isolatePool', 'must be 1 to $MAX_PORT_SHARDS');
+    }
+
+    final workers = <Isolate>[];
+    final readyPort = ReceivePort();
+    final ports = calloc<Int64>(count);
+    try {
+      final ready = readyPort.take(count).toList();
+      for (var i = 0; i < count; i++) {
+        workers.add(await Isolate.spawn(
+            _isolatePoolWorker, (readyPort.sendPort, handler),
+            debugName: 'zenoh $key #$i'));
+      }
+      final sendPorts = await ready;
+      for (var i = 0; i < count; i++) {
+        ports[i] = (sendPorts[i] as SendPort).nativePort;
+      }
+
+      final keyPtr = key.toNativeUtf8().cast<Char>();
+      final subscriberId = _bindings.zenoh_subscribe_ports(keyPtr, ports, count);
+      calloc.free(keyPtr);
+
+      if (subscriberId < 0) {
+        throw Exception('Failed to subscribe to $key, error: $subscriberId');
+      }
+
+      print('ZenohDart: Subscribed ($count isolates) to "$key" '
+          'with ID: $subscriberId');
+      return IsolatePoolSubscriber._(key, subscriberId, workers);
+    } catch (_) {
+      for (final worker in workers) {
+        worker.kill();
+      }
+      rethrow;
+    } finally {
+      calloc.free(ports);
+      readyPort.close();
+    }
+  }
+
   /// Unsubscribe specific subscriber
   static void unsubscribe(int subscriberId) {
     try {
       // Remove callback first
       _activeSubscribers.remove(subscriberId);
+      _activeBytesSubscribers.remove(subscriberId);
 
       // Then unsubscribe on native side
       _bindings.zenoh_unsubscribe(subscriberId);
@@ -196,6 +1410,7 @@ class ZenohDart {
 
     // Clear all Dart callbacks first
     _activeSubscribers.clear();
+    _activeBytesSubscribers.clear();
 
     // Then unsubscribe on native side
     try {
@@ -216,7 +1431,7 @@ class ZenohDart {
     // Small delay to ensure callbacks finish
     await Future.delayed(const Duration(milliseconds: 100));
 
-    // Close session
+    // Close session, which undeclares the queriers and ends every query
     try {
       _bindings.zenoh_close_session();
       print('ZenohDart: Session closed');
@@ -224,9 +1439,29 @@ class ZenohDart {
       print('Error closing session: $e');
     }
 
+    // Each in-flight get still posts its DONE marker through the reply
+    // callable, so it must stay open until they have all arrived
+    if (_pendingGets.isNotEmpty) {
+      final drained = _getsDrained = Completer<void>();
+      await drained.future
+          .timeout(const Duration(seconds: 5), onTimeout: () {});
+      _getsDrained = null;
+    }
+
     // Close the native callable
     _nativeCallable?.close();
     _nativeCallable = null;
+    _nativeBytesCallable?.close();
+    _nativeBytesCallable = null;
+    _nativeReplyCallable?.close();
+    _nativeReplyCallable = null;
+    _nativeQueryCallable?.close();
+    _nativeQueryCallable = null;
+    _activeQueryables.clear();
+    for (final pending in _pendingGets.values) {
+      pending.controller.close();
+    }
+    _pendingGets.clear();
 
     // Cleanup native resources
     try {
@@ -267,6 +1502,108 @@ class ZenohDart {
     }
   }
 
+  /// Declare a publisher on [key] with the QoS of [options].
+  ///
+  /// [encoding] is kept for compatibility, [PublisherOptions.encoding] wins.
+  static Publisher declarePublisher(String key,
+      {String? encoding, PublisherOptions? options}) {
+    final effective = PublisherOptions(
+      encoding: options?.encoding ?? encoding,
+      priority: options?.priority,
+      congestionControl: options?.congestionControl,
+      express: options?.express,
+      reliability: options?.reliability,
+    );
+    final keyPtr = key.toNativeUtf8().cast<Char>();
+    final nativeOptions = effective._toNative();
+
+    final handle = _bindings.zenoh_declare_publisher(keyPtr, nativeOptions);
+
+    calloc.free(keyPtr);
+    PublisherOptions._freeNative(nativeOptions);
+
+    if (handle < 0) {
+      throw Exception('Failed to declare publisher for $key, error: $handle');
+    }
+    return Publisher._(key, handle);
+  }
+
+  /// Declare a queryable answering gets on [key].
+  ///
+  /// With [onQuery] every query is handed to it as it arrives; without it
+  /// queries queue natively, up to [capacity], until [Queryable.drain]; a
+  /// full queue drops its oldest query, which ends it without replies.
+  /// Either way the zenoh thread is released immediately and the query can
+  /// be replied to later.
+  static Queryable declareQueryable(String key,
+      {DartQueryCallback? onQuery,
+      int capacity = 256,
+      int arenaSize = 64 * 1024}) {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
+    final mode =
+        onQuery != null ? QUERYABLE_MODE_CALLBACK : QUERYABLE_MODE_RING;
+    final keyPtr = key.toNativeUtf8().cast<Char>();
+    final handle = _bindings.zenoh_declare_queryable(
+      keyPtr,
+      mode,
+      onQuery != null ? _nativeQueryCallable!.nativeFunction : nullptr,
+      capacity,
+    );
+    calloc.free(keyPtr);
+
+    if (handle < 0) {
+      throw Exception('Failed to declare queryable for $key, error: $handle');
+    }
+
+    if (onQuery != null) {
+      _activeQueryables[handle] = onQuery;
+      return Queryable._(key, handle, mode, null);
+    }
+    return Queryable._(key, handle, mode, SampleArena(arenaSize));
+  }
+
+  /// Hits and misses of the native key expression cache.
+  ///
+  /// Session puts and gets declare their key once it has been used a few
+  /// times and send later ones as a numeric id; a low hit ratio means the
+  /// hot key set is larger than the cache or most keys are one-off.
+  static ({int hits, int misses}) get keyExprCacheStats {
+    final counters = calloc<Uint64>(2);
+    _bindings.zenoh_keyexpr_cache_stats(counters, counters + 1);
+    final stats = (hits: counters[0], misses: counters[1]);
+    calloc.free(counters);
+    return stats;
+  }
+
+  /// Whether [allocShm] hands out real shared memory in this build
+  static bool get isShmAvailable => _bindings.zenoh_shm_available() != 0;
+
+  /// Allocate a [size] byte buffer to fill and publish with [Publisher.putShm]
+  static ShmBuffer allocShm(int size) {
+    final outData = calloc<Pointer<Uint8>>();
+    final handle = _bindings.zenoh_shm_alloc(size, outData);
+    final data = outData.value;
+    calloc.free(outData);
+
+    if (handle == nullptr) {
+      throw Exception('Failed to allocate $size byte publish buffer');
+    }
+    return ShmBuffer._(handle, data.asTypedList(size));
+  }
+
+  /// Take a [size] byte buffer from the plugin pool to fill and publish with
+  /// [Publisher.putBuffer]
+  static PooledBuffer allocBuffer(int size) {
+    final data = _bindings.zenoh_buffer_alloc(size);
+    if (data == nullptr) {
+      throw Exception('Failed to allocate $size byte publish buffer');
+    }
+    return PooledBuffer._(data, data.asTypedList(size));
+  }
+
   /// Publish a value
   static int publish(String key, String value) {
     final keyPtr = key.toNativeUtf8().cast<Char>();
@@ -277,25 +1614,194 @@ class ZenohDart {
     return result < 0 ? -1 : 0;
   }
 
-  /// Put a value
-  static int put(String key, String value) {
+  /// One-shot put, [options] sets the QoS of this put only
+  static int put(String key, String value, {PublisherOptions? options}) {
     final keyPtr = key.toNativeUtf8().cast<Char>();
     final valuePtr = value.toNativeUtf8().cast<Char>();
-    final result = _bindings.zenoh_put(keyPtr, valuePtr);
+    final nativeOptions = options?._toNative() ?? nullptr;
+    final result =
+        _bindings.zenoh_put_with_options(keyPtr, valuePtr, nativeOptions);
     calloc.free(keyPtr);
     calloc.free(valuePtr);
+    if (nativeOptions != nullptr) PublisherOptions._freeNative(nativeOptions);
     return result;
   }
 
-  /// Get a value
-  static String? get(String key) {
+  /// One-shot binary put, [data] is sent as is and may contain NUL bytes.
+  ///
+  /// The key, payload and optional [attachment] are copied once into a
+  /// reused native buffer, so protobuf or CBOR payloads need no string
+  /// conversion or allocation.
+  static int putBytes(String key, Uint8List data,
+      {PublisherOptions? options, Uint8List? attachment}) {
+    final keyBytes = utf8.encode(key);
+    final payloadOffset = keyBytes.length + 1;
+    final attachmentOffset = payloadOffset + data.length;
+    final total = attachmentOffset + (attachment?.length ?? 0);
+
+    final base = _scratch.reserve(total);
+    final staged = base.asTypedList(total);
+    staged.setAll(0, keyBytes);
+    staged[keyBytes.length] = 0;
+    staged.setAll(payloadOffset, data);
+    if (attachment != null) staged.setAll(attachmentOffset, attachment);
+
+    final nativeOptions = options?._toNative() ?? nullptr;
+    final result = _bindings.zenoh_put_bytes(
+        base.cast<Char>(),
+        base + payloadOffset,
+        data.length,
+        attachment == null ? nullptr : base + attachmentOffset,
+        attachment?.length ?? 0,
+        nativeOptions);
+    if (nativeOptions != nullptr) PublisherOptions._freeNative(nativeOptions);
+    return result;
+  }
+
+  /// Query [key] without blocking, emitting every reply as it arrives.
+  ///
+  /// The stream closes once the query is finished. Each [ZenohReply] must be
+  /// released with [ZenohReply.release]; replies arriving after the
+  /// subscription is cancelled are released automatically. [attachment] is
+  /// sent along with the query.
+  static Stream<ZenohReply> getReplies(String key,
+      {String parameters = '',
+      Duration timeout = const Duration(seconds: 5),
+      Uint8List? attachment}) {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
+    return _startGet(key, (requestId) {
+      final keyPtr = key.toNativeUtf8().cast<Char>();
+      final parametersPtr = parameters.toNativeUtf8().cast<Char>();
+      final attachmentPtr = _nativeCopy(attachment);
+      final result = _bindings.zenoh_get_async(
+        keyPtr,
+        parametersPtr,
+        timeout.inMilliseconds,
+        attachmentPtr,
+        attachment?.length ?? 0,
+        _nativeReplyCallable!.nativeFunction,
+        requestId,
+      );
+      calloc.free(keyPtr);
+      calloc.free(parametersPtr);
+      if (attachmentPtr != nullptr) calloc.free(attachmentPtr);
+      return result;
+    });
+  }
+
+  /// Register a reply stream under a new request id and issue the query
+  static Stream<ZenohReply> _startGet(
+      String key, int Function(int requestId) issue) {
+    final requestId = _nextRequestId++;
+    final controller = StreamController<ZenohReply>();
+    final pending = _PendingGet(controller);
+    controller.onCancel = () => pending.cancelled = true;
+    _pendingGets[requestId] = pending;
+
+    final result = issue(requestId);
+    if (result < 0) {
+      _pendingGets.remove(requestId);
+      controller.addError(Exception('Failed to get $key, error: $result'));
+      controller.close();
+    }
+    return controller.stream;
+  }
+
+  /// Declare a querier for repeated gets on [key].
+  ///
+  /// Routing is resolved once at declaration, so each [Querier.get] skips the
+  /// key expression and option setup a plain [getReplies] pays every time.
+  static Querier declareQuerier(String key,
+      {QueryTarget target = QueryTarget.bestMatching,
+      ConsolidationMode consolidation = ConsolidationMode.auto,
+      Duration timeout = const Duration(seconds: 5)}) {
+    if (!_isInitialized) {
+      throw Exception('ZenohDart not initialized. Call initialize() first.');
+    }
+
     final keyPtr = key.toNativeUtf8().cast<Char>();
-    final result = _bindings.zenoh_get(keyPtr);
+    final handle = _bindings.zenoh_declare_querier(
+        keyPtr, target.value, consolidation.value, timeout.inMilliseconds);
     calloc.free(keyPtr);
-    if (result.address != 0) {
-      final dartString = result.cast<Utf8>().toDartString();
-      _bindings.zenoh_free_string(result);
-      return dartString;
+
+    if (handle < 0) {
+      throw Exception('Failed to declare querier for $key, error: $handle');
+    }
+    return Querier._(key, handle);
+  }
+
+  /// Query [key] and collect every reply in a single native call.
+  ///
+  /// The query runs on a helper isolate, so the caller is never blocked.
+  static Future<List<ZenohReplyData>> getAll(String key,
+      {String parameters = '',
+      Duration timeout = const Duration(seconds: 5)}) {
+    final timeoutMs = timeout.inMilliseconds;
+    return Isolate.run(() => _getAllSync(key, parameters, timeoutMs));
+  }
+
+  static List<ZenohReplyData> _getAllSync(
+      String key, String parameters, int timeoutMs) {
+    final keyPtr = key.toNativeUtf8().cast<Char>();
+    final parametersPtr = parameters.toNativeUtf8().cast<Char>();
+    final outBuf = calloc<Pointer<Uint8>>();
+    final outSize = calloc<Size>();
+
+    final count = _bindings.zenoh_get_all(
+        keyPtr, parametersPtr, timeoutMs, outBuf, outSize);
+    final base = outBuf.value;
+    final size = outSize.value;
+
+    calloc.free(keyPtr);
+    calloc.free(parametersPtr);
+    calloc.free(outBuf);
+    calloc.free(outSize);
+
+    if (count < 0) {
+      throw Exception('Failed to get $key, error: $count');
+    }
+
+    final replies = <ZenohReplyData>[];
+    if (base.address == 0) return replies;
+
+    final bytes = base.asTypedList(size);
+    final recordSize = sizeOf<reply_record_t>();
+    var offset = 0;
+    for (var i = 0; i < count; i++) {
+      final record = (base + offset).cast<reply_record_t>().ref;
+      final position = offset + recordSize;
+      final keyEnd = position + record.key_len;
+      final payloadEnd = keyEnd + record.payload_len;
+      final encodingEnd = payloadEnd + record.encoding_len;
+
+      replies.add(ZenohReplyData(
+        utf8.decode(bytes.sublist(position, keyEnd), allowMalformed: true),
+        bytes.sublist(keyEnd, payloadEnd),
+        utf8.decode(bytes.sublist(payloadEnd, encodingEnd),
+            allowMalformed: true),
+        record.timestamp,
+        record.is_error != 0,
+      ));
+
+      offset = (encodingEnd + 7) & ~7;
+    }
+
+    _bindings.zenoh_free_buffer(base);
+    return replies;
+  }
+
+  /// Get a value - completes with the first successful reply
+  static Future<String?> get(String key,
+      {String parameters = '',
+      Duration timeout = const Duration(seconds: 5)}) async {
+    await for (final reply
+        in getReplies(key, parameters: parameters, timeout: timeout)) {
+      final value = reply.isError ? null : reply.payloadString;
+      reply.release();
+      if (value != null) return value;
     }
     return null;
   }
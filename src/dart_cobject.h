@@ -0,0 +1,97 @@
+#ifndef DART_COBJECT_H
+#define DART_COBJECT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Minimal mirror of the Dart_CObject ABI from the Dart SDK's
+// dart_native_api.h, enough to post typed data to a SendPort through the
+// Dart_PostCObject pointer Dart hands over as NativeApi.postCObject.
+// Enum values and field order must match the SDK exactly.
+
+typedef int64_t Dart_Port;
+
+typedef enum {
+    Dart_TypedData_kByteData = 0,
+    Dart_TypedData_kInt8,
+    Dart_TypedData_kUint8,
+    Dart_TypedData_kUint8Clamped,
+    Dart_TypedData_kInt16,
+    Dart_TypedData_kUint16,
+    Dart_TypedData_kInt32,
+    Dart_TypedData_kUint32,
+    Dart_TypedData_kInt64,
+    Dart_TypedData_kUint64,
+    Dart_TypedData_kFloat32,
+    Dart_TypedData_kFloat64,
+    Dart_TypedData_kInt32x4,
+    Dart_TypedData_kFloat32x4,
+    Dart_TypedData_kFloat64x2,
+    Dart_TypedData_kInvalid
+} Dart_TypedData_Type;
+
+typedef enum {
+    Dart_CObject_kNull = 0,
+    Dart_CObject_kBool,
+    Dart_CObject_kInt32,
+    Dart_CObject_kInt64,
+    Dart_CObject_kDouble,
+    Dart_CObject_kString,
+    Dart_CObject_kArray,
+    Dart_CObject_kTypedData,
+    Dart_CObject_kExternalTypedData,
+    Dart_CObject_kSendPort,
+    Dart_CObject_kCapability,
+    Dart_CObject_kNativePointer,
+    Dart_CObject_kUnsupported,
+    Dart_CObject_kUnmodifiableExternalTypedData,
+    Dart_CObject_kNumberOfTypes
+} Dart_CObject_Type;
+
+// Runs on a VM thread once the receiving isolate drops the external data
+typedef void (*Dart_HandleFinalizer)(void* isolate_callback_data, void* peer);
+
+typedef struct _Dart_CObject {
+    Dart_CObject_Type type;
+    union {
+        bool as_bool;
+        int32_t as_int32;
+        int64_t as_int64;
+        double as_double;
+        const char* as_string;
+        struct {
+            Dart_Port id;
+            Dart_Port origin_id;
+        } as_send_port;
+        struct {
+            int64_t id;
+        } as_capability;
+        struct {
+            intptr_t length;
+            struct _Dart_CObject** values;
+        } as_array;
+        struct {
+            Dart_TypedData_Type type;
+            intptr_t length;
+            const uint8_t* values;
+        } as_typed_data;
+        struct {
+            Dart_TypedData_Type type;
+            intptr_t length;
+            uint8_t* data;
+            void* peer;
+            Dart_HandleFinalizer callback;
+        } as_external_typed_data;
+        struct {
+            intptr_t ptr;
+            intptr_t size;
+            Dart_HandleFinalizer callback;
+        } as_native_pointer;
+    } value;
+} Dart_CObject;
+
+// Returns false when the port is closed, the message is then not delivered
+// and its finalizer never runs
+typedef bool (*Dart_PostCObject_Type)(Dart_Port port_id, Dart_CObject* message);
+
+#endif // DART_COBJECT_H
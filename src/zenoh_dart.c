@@ -1,336 +1,2614 @@
 #include "zenoh_dart.h"
 
-// Helper function to convert sample kind to string
-const char *kind_to_str(z_sample_kind_t kind)
+// FNV-1a hash of a key expression
+static uint64_t key_hash(const char *key, size_t len)
 {
-  switch (kind)
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Growable byte buffer used to build result buffers handed to Dart
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    size_t cap;
+} byte_buffer_t;
+
+// Reserve n more bytes and return a pointer to them
+static uint8_t *byte_buffer_grow(byte_buffer_t *buf, size_t n) {
+    if (buf->len + n > buf->cap) {
+        size_t cap = buf->cap ? buf->cap : 256;
+        while (cap < buf->len + n) {
+            cap *= 2;
+        }
+        uint8_t *data = (uint8_t *)realloc(buf->data, cap);
+        if (data == NULL) {
+            return NULL;
+        }
+        buf->data = data;
+        buf->cap = cap;
+    }
+    uint8_t *out = buf->data + buf->len;
+    buf->len += n;
+    return out;
+}
+
+// Pop a free block from a slab class, NULL when the class is exhausted
+static uint8_t *slab_pop(slab_class_t *slab) {
+    uint64_t head = ATOMIC_LOAD(&slab->head);
+    for (;;) {
+        uint32_t index = (uint32_t)head;
+        if (index == SLAB_EMPTY) {
+            return NULL;
+        }
+        // A stale next is harmless, the tag makes the exchange fail
+        uint64_t next = ((head >> 32) + 1) << 32 | ATOMIC_LOAD(&slab->next[index]);
+        if (ATOMIC_CAS64(&slab->head, &head, next)) {
+            return slab->base + (size_t)index * slab->block_size;
+        }
+    }
+}
+
+// Push a block back onto its slab class
+static void slab_push(slab_class_t *slab, uint32_t index) {
+    uint64_t head = ATOMIC_LOAD(&slab->head);
+    for (;;) {
+        slab->next[index] = (uint32_t)head;
+        uint64_t next = ((head >> 32) + 1) << 32 | index;
+        if (ATOMIC_CAS64(&slab->head, &head, next)) {
+            return;
+        }
+    }
+}
+
+// Allocate a callback buffer from the smallest slab class that fits,
+// falling back to malloc when the classes are too small or exhausted
+static void *slab_alloc(size_t size) {
+    for (int i = 0; i < SLAB_CLASSES; i++) {
+        if (g_slabs[i].base != NULL && size <= g_slabs[i].block_size) {
+            uint8_t *block = slab_pop(&g_slabs[i]);
+            if (block != NULL) {
+                return block;
+            }
+        }
+    }
+    return malloc(size);
+}
+
+// Release a slab_alloc() buffer, the owning class is found by address
+static void slab_release(void *buf) {
+    uint8_t *p = (uint8_t *)buf;
+    for (int i = 0; i < SLAB_CLASSES; i++) {
+        slab_class_t *slab = &g_slabs[i];
+        if (slab->base != NULL && p >= slab->base &&
+            p < slab->base + (size_t)slab->block_count * slab->block_size) {
+            slab_push(slab, (uint32_t)((size_t)(p - slab->base) / slab->block_size));
+            return;
+        }
+    }
+    free(buf);
+}
+
+// Size class holding size bytes, -1 when it is too large for the pool
+static int publish_pool_class(size_t size) {
+    int size_class = 0;
+    while (((size_t)1 << (PUBLISH_POOL_MIN_SHIFT + size_class)) < size) {
+        if (++size_class == PUBLISH_POOL_CLASSES) {
+            return -1;
+        }
+    }
+    return size_class;
+}
+
+// Take a buffer of at least size bytes from the pool, returns its payload
+static uint8_t *publish_pool_alloc(size_t size) {
+    int size_class = publish_pool_class(size);
+    pool_buffer_t *buf = NULL;
+
+    if (size_class >= 0) {
+        z_mutex_lock(z_loan_mut(g_publish_pool.mutex));
+        buf = g_publish_pool.free_lists[size_class];
+        if (buf != NULL) {
+            g_publish_pool.free_lists[size_class] = buf->next_free;
+            g_publish_pool.free_counts[size_class]--;
+        }
+        z_mutex_unlock(z_loan_mut(g_publish_pool.mutex));
+    }
+
+    if (buf == NULL) {
+        size_t capacity = size_class >= 0 ? (size_t)1 << (PUBLISH_POOL_MIN_SHIFT + size_class) : size;
+        buf = (pool_buffer_t *)malloc(sizeof(pool_buffer_t) + capacity);
+        if (buf == NULL) {
+            return NULL;
+        }
+        buf->capacity = capacity;
+        buf->size_class = size_class;
+    }
+    buf->next_free = NULL;
+    return (uint8_t *)(buf + 1);
+}
+
+// Return a payload from publish_pool_alloc(), called from zenoh threads too
+static void publish_pool_release(uint8_t *data) {
+    pool_buffer_t *buf = (pool_buffer_t *)data - 1;
+    int size_class = buf->size_class;
+
+    if (size_class >= 0) {
+        z_mutex_lock(z_loan_mut(g_publish_pool.mutex));
+        if (g_publish_pool.free_counts[size_class] < PUBLISH_POOL_MAX_FREE) {
+            buf->next_free = g_publish_pool.free_lists[size_class];
+            g_publish_pool.free_lists[size_class] = buf;
+            g_publish_pool.free_counts[size_class]++;
+            buf = NULL;
+        }
+        z_mutex_unlock(z_loan_mut(g_publish_pool.mutex));
+    }
+    free(buf);
+}
+
+// z_bytes_from_buf() deleter handing the buffer back to the pool
+static void publish_pool_deleter(void *data, void *context) {
+    (void)context;
+    publish_pool_release((uint8_t *)data);
+}
+
+// Free every cached buffer, in-flight ones still return to the pool later
+static void trim_publish_pool(void) {
+    z_mutex_lock(z_loan_mut(g_publish_pool.mutex));
+    for (int i = 0; i < PUBLISH_POOL_CLASSES; i++) {
+        while (g_publish_pool.free_lists[i] != NULL) {
+            pool_buffer_t *buf = g_publish_pool.free_lists[i];
+            g_publish_pool.free_lists[i] = buf->next_free;
+            free(buf);
+        }
+        g_publish_pool.free_counts[i] = 0;
+    }
+    z_mutex_unlock(z_loan_mut(g_publish_pool.mutex));
+}
+
+// Record accessors, index must be below chunk_count * SUBSCRIBER_CHUNK_SIZE
+static subscriber_t* subscriber_at(int index) {
+    return &g_subscribers.chunks[index / SUBSCRIBER_CHUNK_SIZE]->hot[index % SUBSCRIBER_CHUNK_SIZE];
+}
+
+static subscriber_info_t* subscriber_info_at(int index) {
+    return &g_subscribers.chunks[index / SUBSCRIBER_CHUNK_SIZE]->cold[index % SUBSCRIBER_CHUNK_SIZE];
+}
+
+// Add a chunk of records to the free list - table mutex must be held
+static bool grow_subscriber_table(void) {
+    if ((g_subscribers.chunk_count + 1) * SUBSCRIBER_CHUNK_SIZE > MAX_SUBSCRIBERS) {
+        return false;
+    }
+
+    if (g_subscribers.chunk_count == g_subscribers.chunk_capacity) {
+        int capacity = g_subscribers.chunk_capacity ? g_subscribers.chunk_capacity * 2 : 4;
+        subscriber_chunk_t** chunks = (subscriber_chunk_t**)realloc(g_subscribers.chunks, capacity * sizeof(subscriber_chunk_t*));
+        if (chunks == NULL) {
+            return false;
+        }
+        g_subscribers.chunks = chunks;
+        g_subscribers.chunk_capacity = capacity;
+    }
+
+    subscriber_chunk_t* chunk = (subscriber_chunk_t*)calloc(1, sizeof(subscriber_chunk_t));
+    if (chunk == NULL) {
+        return false;
+    }
+
+    int base = g_subscribers.chunk_count * SUBSCRIBER_CHUNK_SIZE;
+    g_subscribers.chunks[g_subscribers.chunk_count++] = chunk;
+
+    // Thread the new records onto the free list in index order
+    for (int i = SUBSCRIBER_CHUNK_SIZE - 1; i >= 0; i--) {
+        chunk->hot[i].id = base + i;
+        chunk->cold[i].next_free = g_subscribers.free_head;
+        g_subscribers.free_head = base + i;
+    }
+    return true;
+}
+
+// Pop a free record index, growing the table if needed - table mutex must be held
+static int alloc_subscriber_slot(void) {
+    if (g_subscribers.free_head == -1 && !grow_subscriber_table()) {
+        return -1;
+    }
+    int index = g_subscribers.free_head;
+    g_subscribers.free_head = subscriber_info_at(index)->next_free;
+    return index;
+}
+
+// Return a record to the free list and bump its generation - table mutex must be held
+static void release_subscriber_slot(int index) {
+    subscriber_t* sub = subscriber_at(index);
+    subscriber_info_t* info = subscriber_info_at(index);
+
+    int generation = ((unsigned)sub->id >> SUBSCRIBER_INDEX_BITS) + 1;
+    sub->id = (int)(((unsigned)generation << SUBSCRIBER_INDEX_BITS) & INT_MAX) | index;
+    sub->active = false;
+    sub->callback = NULL;
+    sub->bytes_callback = NULL;
+    info->declared = false;
+
+    // LATEST channels belong to the closure and were detached before it was
+    // dropped, see detach_latest_channel()
+    if (info->pull != NULL) {
+        // The subscriber is gone, so the channel no longer has a sender
+        if (info->pull->mode == SUBSCRIBER_MODE_FIFO) {
+            z_drop(z_move(info->pull->fifo));
+        } else {
+            z_drop(z_move(info->pull->ring));
+        }
+        if (info->pull->has_pending) {
+            z_drop(z_move(info->pull->pending));
+        }
+        free(info->pull);
+        info->pull = NULL;
+    }
+
+    free(info->key_expr);
+    info->key_expr = NULL;
+    info->next_free = g_subscribers.free_head;
+    g_subscribers.free_head = index;
+}
+
+// Forget a LATEST channel before its closure is dropped, the drop runs
+// latest_channel_drop() which frees it - table mutex must be held
+static void detach_latest_channel(int index) {
+    subscriber_info_t* info = subscriber_info_at(index);
+    if (info->pull != NULL && info->pull->mode == SUBSCRIBER_MODE_LATEST) {
+        info->pull = NULL;
+    }
+}
+
+// Undeclare a record's subscriber and free the record - table mutex must be held
+static void drop_subscriber_slot(int index) {
+    subscriber_at(index)->active = false;
+    detach_latest_channel(index);
+    z_drop(z_move(subscriber_info_at(index)->subscriber));
+    release_subscriber_slot(index);
+}
+
+// Map a subscriber id to its record index - table mutex must be held
+static int find_subscriber_slot_by_id(int subscriber_id) {
+    if (subscriber_id < 0) {
+        return -1;
+    }
+    int index = subscriber_id & SUBSCRIBER_INDEX_MASK;
+    if (index >= g_subscribers.chunk_count * SUBSCRIBER_CHUNK_SIZE) {
+        return -1;
+    }
+    subscriber_t* sub = subscriber_at(index);
+    return (sub->active && sub->id == subscriber_id) ? index : -1;
+}
+
+// Resolve a closure context to its subscriber, NULL once it was unsubscribed
+static subscriber_t* subscriber_from_ref(const subscriber_ref_t *ref) {
+    subscriber_t *sub = ref->sub;
+    return (sub->active && sub->id == ref->id) ? sub : NULL;
+}
+
+// Find free publisher slot, a slot being declared already holds its key - mutex must be held
+static int find_free_publisher_slot(void) {
+    for (int i = 0; i < MAX_PUBLISHERS; i++) {
+        if (!g_publishers[i].active && g_publishers[i].key_expr[0] == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Find free querier slot, a slot being declared already holds its key - mutex must be held
+static int find_free_querier_slot(void) {
+    for (int i = 0; i < MAX_QUERIERS; i++) {
+        if (!g_queriers[i].active && g_queriers[i].key_expr[0] == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Undeclare every querier, must run before the session is dropped
+static void undeclare_all_queriers(void) {
+    z_mutex_lock(z_loan_mut(g_queriers_mutex));
+    for (int i = 0; i < MAX_QUERIERS; i++) {
+        if (g_queriers[i].active) {
+            z_drop(z_move(g_queriers[i].querier));
+            g_queriers[i].active = false;
+            g_queriers[i].key_expr[0] = '\0';
+        }
+    }
+    z_mutex_unlock(z_loan_mut(g_queriers_mutex));
+}
+
+// Drop a query handle, sending the final reply to the querier
+static void query_handle_free(query_handle_t *handle) {
+    if (handle->owns_slice) {
+        z_drop(z_move(handle->slice));
+    }
+    if (handle->owns_attachment_slice) {
+        z_drop(z_move(handle->attachment_slice));
+    }
+    z_drop(z_move(handle->query));
+    free(handle);
+}
+
+// Find free queryable slot, a slot being declared already holds its key - mutex must be held
+static int find_free_queryable_slot(void) {
+    for (int i = 0; i < MAX_QUERYABLES; i++) {
+        if (!g_queryables[i].active && g_queryables[i].key_expr[0] == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Undeclare a queryable and drop the queries it still queues - mutex must be held
+static void release_queryable_slot(int index) {
+    queryable_t *q = &g_queryables[index];
+    z_drop(z_move(q->queryable));
+    if (q->mode == QUERYABLE_MODE_RING) {
+        z_drop(z_move(q->ring));
+    }
+    if (q->pending != NULL) {
+        query_handle_free(q->pending);
+        q->pending = NULL;
+    }
+    q->active = false;
+    q->key_expr[0] = '\0';
+}
+
+// Undeclare every queryable, must run before the session is dropped
+static void undeclare_all_queryables(void) {
+    z_mutex_lock(z_loan_mut(g_queryables_mutex));
+    for (int i = 0; i < MAX_QUERYABLES; i++) {
+        if (g_queryables[i].active) {
+            release_queryable_slot(i);
+        }
+    }
+    z_mutex_unlock(z_loan_mut(g_queryables_mutex));
+}
+
+// Drop the SHM provider, must run before the session is dropped
+static void release_shm_provider(void) {
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    z_mutex_lock(z_loan_mut(shm_provider_mutex));
+    if (shm_provider_ready) {
+        z_drop(z_move(shm_provider));
+        shm_provider_ready = false;
+    }
+    z_mutex_unlock(z_loan_mut(shm_provider_mutex));
+#endif
+}
+
+// Undeclare every publisher, must run before the session is dropped
+static void undeclare_all_publishers(void) {
+    z_mutex_lock(z_loan_mut(g_publishers_mutex));
+    for (int i = 0; i < MAX_PUBLISHERS; i++) {
+        if (g_publishers[i].active) {
+            z_drop(z_move(g_publishers[i].publisher));
+            g_publishers[i].active = false;
+            g_publishers[i].key_expr[0] = '\0';
+        }
+    }
+    z_mutex_unlock(z_loan_mut(g_publishers_mutex));
+}
+
+// Bucket holding key, or the empty bucket it belongs in
+static key_bucket_t *key_table_slot(key_bucket_t *buckets, size_t bucket_count,
+                                    const char *key, size_t key_len, uint64_t hash)
+{
+    size_t mask = bucket_count - 1;
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+        key_bucket_t *bucket = &buckets[i];
+        if (bucket->key == NULL ||
+            (bucket->hash == hash && bucket->key_len == key_len && memcmp(bucket->key, key, key_len) == 0)) {
+            return bucket;
+        }
+    }
+}
+
+// Double the bucket count, keeping the load factor at or below one half
+static bool key_table_grow(key_table_t *table)
+{
+    size_t bucket_count = table->bucket_count ? table->bucket_count * 2 : 256;
+    key_bucket_t *buckets = (key_bucket_t *)calloc(bucket_count, sizeof(key_bucket_t));
+    if (buckets == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < table->bucket_count; i++) {
+        key_bucket_t *old = &table->buckets[i];
+        if (old->key != NULL) {
+            *key_table_slot(buckets, bucket_count, old->key, old->key_len, old->hash) = *old;
+        }
+    }
+    free(table->buckets);
+    table->buckets = buckets;
+    table->bucket_count = bucket_count;
+    return true;
+}
+
+// Id of key in the intern table, adding it on first sight
+// *interned is set to the table's null-terminated copy
+// Returns -1 when the table is full or out of memory
+static int intern_key(const char *key, size_t key_len, const char **interned)
+{
+    uint64_t hash = key_hash(key, key_len);
+    int id = -1;
+
+    z_mutex_lock(z_loan_mut(g_key_table.mutex));
+    if ((size_t)(g_key_table.count + 1) * 2 > g_key_table.bucket_count &&
+        g_key_table.count < KEY_TABLE_MAX) {
+        key_table_grow(&g_key_table);
+    }
+
+    if (g_key_table.bucket_count > 0) {
+        key_bucket_t *bucket = key_table_slot(g_key_table.buckets, g_key_table.bucket_count, key, key_len, hash);
+        if (bucket->key == NULL && g_key_table.count < KEY_TABLE_MAX &&
+            (size_t)(g_key_table.count + 1) * 2 <= g_key_table.bucket_count) {
+            bucket->key = (char *)malloc(key_len + 1);
+            if (bucket->key != NULL) {
+                memcpy(bucket->key, key, key_len);
+                bucket->key[key_len] = '\0';
+                bucket->key_len = key_len;
+                bucket->hash = hash;
+                bucket->id = g_key_table.count++;
+            }
+        }
+        if (bucket->key != NULL) {
+            id = bucket->id;
+            *interned = bucket->key;
+        }
+    }
+    z_mutex_unlock(z_loan_mut(g_key_table.mutex));
+    return id;
+}
+
+// Data handler for subscriber - called when data is received
+void data_handler(z_loaned_sample_t *sample, void *arg)
+{
+    const subscriber_ref_t *ref = (const subscriber_ref_t *)arg;
+    int subscriber_id = ref->id;
+    subscriber_t* sub = subscriber_from_ref(ref);
+    // Read once, an unsubscribe can clear it while this sample is in flight
+    SubscriberCallback callback = sub != NULL ? sub->callback : NULL;
+
+    if (callback == NULL) {
+        printf("Subscriber not found or no callback: %d\n", subscriber_id);
+        return;
+    }
+
+    // Extract key, interned so repeated keys cost no allocation on either side
+    z_view_string_t key_string;
+    z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_string);
+    size_t key_len = z_string_len(z_loan(key_string));
+    const char *key = NULL;
+    int key_id = intern_key(z_string_data(z_loan(key_string)), key_len, &key);
+
+    const z_loaned_bytes_t *attachment = z_sample_attachment(sample);
+    size_t attachment_len = attachment != NULL ? z_bytes_len(attachment) : 0;
+    const uint8_t *attachment_data = NULL;
+
+    // The payload, followed by the attachment and by the key when it could
+    // not be interned, goes in one slab block that Dart hands back with
+    // zenoh_release(value)
+    const z_loaned_bytes_t *payload = z_sample_payload(sample);
+    size_t payload_len = z_bytes_len(payload);
+    size_t block_len = payload_len + 1 + attachment_len + (key_id < 0 ? key_len + 1 : 0);
+
+    char *payload_buf = (char *)slab_alloc(block_len);
+
+    if (payload_buf) {
+        z_bytes_reader_t reader = z_bytes_get_reader(payload);
+        z_bytes_reader_read(&reader, (uint8_t *)payload_buf, payload_len);
+        payload_buf[payload_len] = '\0';
+        char *tail = payload_buf + payload_len + 1;
+
+        // Binary safe, the attachment is passed with its length and not terminated
+        if (attachment != NULL) {
+            z_bytes_reader_t attachment_reader = z_bytes_get_reader(attachment);
+            z_bytes_reader_read(&attachment_reader, (uint8_t *)tail, attachment_len);
+            attachment_data = (const uint8_t *)tail;
+            tail += attachment_len;
+        }
+
+        if (key_id < 0) {
+            char *key_buf = tail;
+            memcpy(key_buf, z_string_data(z_loan(key_string)), key_len);
+            key_buf[key_len] = '\0';
+            key = key_buf;
+        }
+
+        // CRITICAL: Pass ownership to Dart
+        // Dart MUST return the block using zenoh_release(value)
+        callback(key, key_id, payload_buf, (int)z_sample_kind(sample), attachment_data, attachment_len,
+                 subscriber_id);
+    } else {
+        printf("Failed to allocate callback buffer\n");
+    }
+}
+
+// Borrow the payload when zenoh stores it as a single contiguous slice
+static bool payload_contiguous_view(const z_loaned_bytes_t *payload, const uint8_t **data, size_t *len)
+{
+    size_t total = z_bytes_len(payload);
+    if (total == 0) {
+        *data = NULL;
+        *len = 0;
+        return true;
+    }
+
+    z_bytes_slice_iterator_t it = z_bytes_get_slice_iterator(payload);
+    z_view_slice_t slice;
+    if (!z_bytes_slice_iterator_next(&it, &slice) || z_slice_len(z_loan(slice)) != total) {
+        return false;
+    }
+
+    *data = z_slice_data(z_loan(slice));
+    *len = total;
+    return true;
+}
+
+// Resolve a payload view, flattening it into slice once when it is fragmented
+static int payload_bind_view(const z_loaned_bytes_t *payload, z_owned_slice_t *slice, bool *owns_slice,
+                             const uint8_t **data, size_t *len)
+{
+    *owns_slice = false;
+    if (payload_contiguous_view(payload, data, len)) {
+        return 0;
+    }
+
+    if (z_bytes_to_slice(payload, slice) < 0) {
+        return -1;
+    }
+    *owns_slice = true;
+    *data = z_slice_data(z_loan(*slice));
+    *len = z_slice_len(z_loan(*slice));
+    return 0;
+}
+
+// Resolve a payload view whose memory is kept alive by the handle
+static int sample_handle_bind_payload(sample_handle_t *handle, const z_loaned_bytes_t *payload,
+                                      const uint8_t **data, size_t *len)
+{
+    handle->is_shm = false;
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    // Shared memory payloads are already mapped, lend the mapping itself
+    const z_loaned_shm_t *shm;
+    if (z_bytes_as_loaned_shm(payload, &shm) == Z_OK) {
+        handle->owns_slice = false;
+        handle->is_shm = true;
+        *data = z_shm_data(shm);
+        *len = z_shm_len(shm);
+        return 0;
+    }
+#endif
+    return payload_bind_view(payload, &handle->slice, &handle->owns_slice, data, len);
+}
+
+// Resolve the sample's attachment view, data is NULL when there is none
+static int sample_handle_bind_attachment(sample_handle_t *handle, const z_loaned_sample_t *sample,
+                                         const uint8_t **data, size_t *len)
+{
+    handle->owns_attachment_slice = false;
+    const z_loaned_bytes_t *attachment = z_sample_attachment(sample);
+    if (attachment == NULL) {
+        *data = NULL;
+        *len = 0;
+        return 0;
+    }
+    return payload_bind_view(attachment, &handle->attachment_slice, &handle->owns_attachment_slice, data, len);
+}
+
+// Drop the slices a sample handle owns
+static void sample_handle_drop_slices(sample_handle_t *handle)
+{
+    if (handle->owns_slice) {
+        z_drop(z_move(handle->slice));
+    }
+    if (handle->owns_attachment_slice) {
+        z_drop(z_move(handle->attachment_slice));
+    }
+}
+
+// Binary data handler - takes ownership of the sample and lends Dart a view into it
+void bytes_data_handler(z_loaned_sample_t *sample, void *arg)
+{
+    const subscriber_ref_t *ref = (const subscriber_ref_t *)arg;
+    int subscriber_id = ref->id;
+    subscriber_t* sub = subscriber_from_ref(ref);
+    // Read once, an unsubscribe can clear it while this sample is in flight
+    SubscriberBytesCallback callback = sub != NULL ? sub->bytes_callback : NULL;
+
+    if (callback == NULL) {
+        printf("Subscriber not found or no callback: %d\n", subscriber_id);
+        return;
+    }
+
+    sample_handle_t *handle = (sample_handle_t *)malloc(sizeof(sample_handle_t));
+    if (handle == NULL) {
+        return;
+    }
+    handle->is_shm = false;
+    handle->owns_slice = false;
+    handle->owns_attachment_slice = false;
+    handle->refs = 1;
+
+    // Keep the sample alive until Dart calls zenoh_sample_release()
+    z_sample_take_from_loaned(&handle->sample, sample);
+
+    const z_loaned_sample_t *held = z_loan(handle->sample);
+    const uint8_t *payload_data;
+    size_t payload_len;
+    const uint8_t *attachment_data;
+    size_t attachment_len;
+
+    if (sample_handle_bind_payload(handle, z_sample_payload(held), &payload_data, &payload_len) < 0 ||
+        sample_handle_bind_attachment(handle, held, &attachment_data, &attachment_len) < 0) {
+        printf("Failed to extract payload\n");
+        sample_handle_drop_slices(handle);
+        z_drop(z_move(handle->sample));
+        free(handle);
+        return;
+    }
+
+    z_view_string_t key_string;
+    z_keyexpr_as_view_string(z_sample_keyexpr(held), &key_string);
+
+    // Dart owns the handle from here on
+    callback(z_string_data(z_loan(key_string)), z_string_len(z_loan(key_string)),
+             payload_data, payload_len, attachment_data, attachment_len,
+             (int)z_sample_kind(held), handle->is_shm,
+             handle, subscriber_id);
+}
+
+// Bucket holding key, or the empty bucket it belongs in
+static latest_entry_t *latest_map_slot(latest_entry_t *entries, size_t bucket_count,
+                                       const char *key, size_t key_len, uint64_t hash)
+{
+    size_t mask = bucket_count - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        latest_entry_t *entry = &entries[i];
+        if (entry->key == NULL ||
+            (entry->hash == hash && entry->key_len == key_len && memcmp(entry->key, key, key_len) == 0)) {
+            return entry;
+        }
+    }
+}
+
+// Size the map for capacity distinct keys below a 3/4 load factor
+static bool latest_map_init(latest_map_t *map, size_t capacity)
+{
+    size_t bucket_count = 16;
+    while (bucket_count * 3 < capacity * 4) {
+        bucket_count *= 2;
+    }
+    map->entries = (latest_entry_t *)calloc(bucket_count, sizeof(latest_entry_t));
+    if (map->entries == NULL) {
+        return false;
+    }
+    map->bucket_count = bucket_count;
+    map->count = 0;
+    map->dirty_count = 0;
+    map->cursor = 0;
+    z_mutex_init(&map->mutex);
+    return true;
+}
+
+// Double the bucket count, moving entries as is - map mutex must be held
+static bool latest_map_grow(latest_map_t *map)
+{
+    size_t bucket_count = map->bucket_count * 2;
+    latest_entry_t *entries = (latest_entry_t *)calloc(bucket_count, sizeof(latest_entry_t));
+    if (entries == NULL) {
+        return false;
+    }
+    for (size_t i = 0; i < map->bucket_count; i++) {
+        latest_entry_t *old = &map->entries[i];
+        if (old->key != NULL) {
+            *latest_map_slot(entries, bucket_count, old->key, old->key_len, old->hash) = *old;
+        }
+    }
+    free(map->entries);
+    map->entries = entries;
+    map->bucket_count = bucket_count;
+    map->cursor = 0;
+    return true;
+}
+
+// Coalescing handler - replaces the stored sample of the key, nothing crosses into Dart
+void latest_data_handler(z_loaned_sample_t *sample, void *arg)
+{
+    latest_map_t *map = &((pull_channel_t *)arg)->latest;
+
+    z_view_string_t key_string;
+    z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_string);
+    const char *key = z_string_data(z_loan(key_string));
+    size_t key_len = z_string_len(z_loan(key_string));
+    uint64_t hash = key_hash(key, key_len);
+
+    z_mutex_lock(z_loan_mut(map->mutex));
+
+    latest_entry_t *entry = latest_map_slot(map->entries, map->bucket_count, key, key_len, hash);
+    if (entry->key == NULL) {
+        if ((map->count + 1) * 4 > map->bucket_count * 3) {
+            if (!latest_map_grow(map)) {
+                z_mutex_unlock(z_loan_mut(map->mutex));
+                printf("Failed to grow latest-value map, sample dropped\n");
+                return;
+            }
+            entry = latest_map_slot(map->entries, map->bucket_count, key, key_len, hash);
+        }
+        // The view dies with the sample, so the map keeps its own copy of the key
+        char *key_copy = (char *)malloc(key_len + 1);
+        if (key_copy == NULL) {
+            z_mutex_unlock(z_loan_mut(map->mutex));
+            return;
+        }
+        memcpy(key_copy, key, key_len);
+        key_copy[key_len] = '\0';
+        entry->key = key_copy;
+        entry->key_len = key_len;
+        entry->hash = hash;
+        map->count++;
+    } else {
+        z_drop(z_move(entry->sample));
+    }
+
+    z_sample_take_from_loaned(&entry->sample, sample);
+    if (!entry->dirty) {
+        entry->dirty = true;
+        map->dirty_count++;
+    }
+
+    z_mutex_unlock(z_loan_mut(map->mutex));
+}
+
+// Closure drop of a coalescing subscriber - the map is freed once no sample can reach it
+void latest_channel_drop(void *arg)
+{
+    pull_channel_t *pull = (pull_channel_t *)arg;
+    latest_map_t *map = &pull->latest;
+    for (size_t i = 0; i < map->bucket_count; i++) {
+        latest_entry_t *entry = &map->entries[i];
+        if (entry->key != NULL) {
+            free(entry->key);
+            z_drop(z_move(entry->sample));
+        }
+    }
+    free(map->entries);
+    z_drop(z_move(map->mutex));
+    free(pull);
+}
+
+// Async reply handler - lends each reply to Dart through a sample handle
+void async_reply_handler(z_loaned_reply_t *reply, void *context)
+{
+    get_context_t *ctx = (get_context_t *)context;
+
+    sample_handle_t *handle = (sample_handle_t *)malloc(sizeof(sample_handle_t));
+    if (handle == NULL) {
+        return;
+    }
+    handle->is_shm = false;
+    handle->owns_slice = false;
+    handle->owns_attachment_slice = false;
+    handle->refs = 1;
+
+    const char *key_data = NULL;
+    size_t key_len = 0;
+    const uint8_t *payload_data;
+    size_t payload_len;
+    const uint8_t *attachment_data = NULL;
+    size_t attachment_len = 0;
+    int status;
+
+    if (z_reply_is_ok(reply)) {
+        z_sample_clone(&handle->sample, z_reply_ok(reply));
+        const z_loaned_sample_t *held = z_loan(handle->sample);
+
+        if (sample_handle_bind_payload(handle, z_sample_payload(held), &payload_data, &payload_len) < 0 ||
+            sample_handle_bind_attachment(handle, held, &attachment_data, &attachment_len) < 0) {
+            sample_handle_drop_slices(handle);
+            z_drop(z_move(handle->sample));
+            free(handle);
+            return;
+        }
+
+        z_view_string_t key_string;
+        z_keyexpr_as_view_string(z_sample_keyexpr(held), &key_string);
+        key_data = z_string_data(z_loan(key_string));
+        key_len = z_string_len(z_loan(key_string));
+        status = ZENOH_REPLY_OK;
+    } else {
+        // Error payloads live in the loaned reply, so they are always copied
+        z_internal_sample_null(&handle->sample);
+        if (z_bytes_to_slice(z_reply_err_payload(z_reply_err(reply)), &handle->slice) < 0) {
+            free(handle);
+            return;
+        }
+        handle->owns_slice = true;
+        payload_data = z_slice_data(z_loan(handle->slice));
+        payload_len = z_slice_len(z_loan(handle->slice));
+        status = ZENOH_REPLY_ERROR;
+    }
+
+    // Dart owns the handle from here on
+    ctx->callback(ctx->request_id, status, key_data, key_len, payload_data, payload_len,
+                  attachment_data, attachment_len, handle);
+}
+
+// Called by zenoh once the query is finished - no more replies will arrive
+void async_reply_dropper(void *context)
+{
+    get_context_t *ctx = (get_context_t *)context;
+    ctx->callback(ctx->request_id, ZENOH_REPLY_DONE, NULL, 0, NULL, 0, NULL, 0, NULL);
+    free(ctx);
+}
+
+// Copy a payload into a new NUL-terminated string
+static char *payload_to_cstr(const z_loaned_bytes_t *payload)
+{
+  size_t len = z_bytes_len(payload);
+  char *value = (char *)malloc(len + 1);
+  if (value)
+  {
+    z_bytes_reader_t reader = z_bytes_get_reader(payload);
+    size_t bytes_read = z_bytes_reader_read(&reader, (uint8_t *)value, len);
+    value[bytes_read] = '\0';
+  }
+  return value;
+}
+
+// Drop one reference to a blocking get context, the last one frees it
+static void get_sync_context_release(get_sync_context_t *ctx)
+{
+  z_mutex_lock(z_loan_mut(ctx->mutex));
+  bool last = --ctx->refs == 0;
+  z_mutex_unlock(z_loan_mut(ctx->mutex));
+
+  if (last)
+  {
+    free(ctx->value);
+    z_drop(z_move(ctx->condvar));
+    z_drop(z_move(ctx->mutex));
+    free(ctx);
+  }
+}
+
+// Reply callback function for zenoh_get - keeps the first successful reply
+void reply_callback(z_loaned_reply_t *reply, void *context)
+{
+  get_sync_context_t *ctx = (get_sync_context_t *)context;
+  if (!z_reply_is_ok(reply))
+  {
+    return;
+  }
+
+  z_mutex_lock(z_loan_mut(ctx->mutex));
+  if (ctx->value == NULL && !ctx->taken)
+  {
+    ctx->value = payload_to_cstr(z_sample_payload(z_reply_ok(reply)));
+    z_condvar_signal(z_loan(ctx->condvar));
+  }
+  z_mutex_unlock(z_loan_mut(ctx->mutex));
+}
+
+// Called by zenoh once the query is finished
+void reply_dropper(void *context)
+{
+  get_sync_context_t *ctx = (get_sync_context_t *)context;
+
+  z_mutex_lock(z_loan_mut(ctx->mutex));
+  ctx->done = true;
+  z_condvar_signal(z_loan(ctx->condvar));
+  z_mutex_unlock(z_loan_mut(ctx->mutex));
+
+  get_sync_context_release(ctx);
+}
+
+// Zenoh-C function implementations
+// Entry index of key in the key expression cache, -1 when it is not declared
+static int keyexpr_cache_find(const char *key, uint64_t hash)
+{
+    int i = g_keyexpr_cache.buckets[hash & (KEYEXPR_CACHE_BUCKETS - 1)];
+    while (i >= 0) {
+        keyexpr_entry_t *entry = &g_keyexpr_cache.entries[i];
+        if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+            return i;
+        }
+        i = entry->next;
+    }
+    return -1;
+}
+
+// Free entry, or the least recently used unpinned one, -1 when all are pinned
+static int keyexpr_cache_victim(void)
+{
+    int victim = -1;
+    for (int i = 0; i < KEYEXPR_CACHE_SIZE; i++) {
+        keyexpr_entry_t *entry = &g_keyexpr_cache.entries[i];
+        if (!entry->active) {
+            return i;
+        }
+        if (entry->users == 0 &&
+            (victim < 0 || entry->last_used < g_keyexpr_cache.entries[victim].last_used)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+// Remove an active entry from its bucket chain
+static void keyexpr_cache_unlink(int index)
+{
+    keyexpr_entry_t *entry = &g_keyexpr_cache.entries[index];
+    int *link = &g_keyexpr_cache.buckets[entry->hash & (KEYEXPR_CACHE_BUCKETS - 1)];
+    while (*link != index) {
+        link = &g_keyexpr_cache.entries[*link].next;
+    }
+    *link = entry->next;
+    entry->active = false;
+}
+
+// Count a use of an undeclared key, true once it is hot enough to declare
+// Only the caller that crosses the threshold is told to declare
+static bool keyexpr_cache_admit(uint64_t hash)
+{
+    keyexpr_admit_t *slot = &g_keyexpr_cache.admit[hash & (KEYEXPR_ADMIT_SLOTS - 1)];
+    if (slot->hash != hash) {
+        slot->hash = hash;
+        slot->count = 0;
+    }
+    if (++slot->count < KEYEXPR_ADMIT_HITS) {
+        return false;
+    }
+    slot->count = 0;
+    return true;
+}
+
+// Declared key expression for key, pinned until keyexpr_cache_release()
+// NULL until key has been used KEYEXPR_ADMIT_HITS times, when it cannot be
+// declared or when the cache is full of pinned entries, the caller then
+// falls back to a view of key
+static keyexpr_entry_t *keyexpr_cache_acquire(const char *key)
+{
+    size_t len = strlen(key);
+    uint64_t hash = key_hash(key, len);
+    keyexpr_entry_t *found = NULL;
+
+    z_mutex_lock(z_loan_mut(g_keyexpr_cache.mutex));
+    uint64_t now = ++g_keyexpr_cache.clock;
+    int index = keyexpr_cache_find(key, hash);
+    bool admit = false;
+    if (index >= 0) {
+        g_keyexpr_cache.hits++;
+        found = &g_keyexpr_cache.entries[index];
+        found->last_used = now;
+        ATOMIC_INCREMENT(&found->users);
+    } else {
+        g_keyexpr_cache.misses++;
+        admit = keyexpr_cache_admit(hash);
+    }
+    z_mutex_unlock(z_loan_mut(g_keyexpr_cache.mutex));
+    if (!admit) {
+        return found;
+    }
+
+    // Declared outside the lock so puts and gets never wait on the network
+    z_view_keyexpr_t view;
+    if (z_view_keyexpr_from_str(&view, key) < 0) {
+        return NULL;
+    }
+    char *key_copy = (char *)malloc(len + 1);
+    if (key_copy == NULL) {
+        return NULL;
+    }
+    memcpy(key_copy, key, len + 1);
+    z_owned_keyexpr_t declared;
+    if (z_declare_keyexpr(z_loan(session), &declared, z_loan(view)) < 0) {
+        free(key_copy);
+        return NULL;
+    }
+
+    z_owned_keyexpr_t evicted;
+    bool has_evicted = false;
+
+    z_mutex_lock(z_loan_mut(g_keyexpr_cache.mutex));
+    // Another caller may have declared the key meanwhile
+    index = keyexpr_cache_find(key, hash);
+    if (index < 0) {
+        index = keyexpr_cache_victim();
+        if (index >= 0) {
+            keyexpr_entry_t *entry = &g_keyexpr_cache.entries[index];
+            if (entry->active) {
+                keyexpr_cache_unlink(index);
+                z_take(&evicted, z_move(entry->keyexpr));
+                free(entry->key);
+                has_evicted = true;
+            }
+            z_take(&entry->keyexpr, z_move(declared));
+            entry->key = key_copy;
+            entry->hash = hash;
+            entry->users = 0;
+            entry->active = true;
+            int *bucket = &g_keyexpr_cache.buckets[hash & (KEYEXPR_CACHE_BUCKETS - 1)];
+            entry->next = *bucket;
+            *bucket = index;
+            key_copy = NULL;
+        }
+    }
+    if (index >= 0) {
+        found = &g_keyexpr_cache.entries[index];
+        found->last_used = now;
+        ATOMIC_INCREMENT(&found->users);
+    }
+    z_mutex_unlock(z_loan_mut(g_keyexpr_cache.mutex));
+
+    // Undeclarations also go out without the lock held
+    if (key_copy != NULL) {
+        z_undeclare_keyexpr(z_loan(session), z_move(declared));
+        free(key_copy);
+    }
+    if (has_evicted) {
+        z_undeclare_keyexpr(z_loan(session), z_move(evicted));
+    }
+    return found;
+}
+
+// Unpin an entry from keyexpr_cache_acquire()
+static void keyexpr_cache_release(keyexpr_entry_t *entry)
+{
+    ATOMIC_DECREMENT(&entry->users);
+}
+
+// Undeclare every cached key expression, must run before the session is dropped
+static void clear_keyexpr_cache(void)
+{
+    z_mutex_lock(z_loan_mut(g_keyexpr_cache.mutex));
+    for (int i = 0; i < KEYEXPR_CACHE_SIZE; i++) {
+        keyexpr_entry_t *entry = &g_keyexpr_cache.entries[i];
+        if (entry->active) {
+            z_undeclare_keyexpr(z_loan(session), z_move(entry->keyexpr));
+            free(entry->key);
+            entry->key = NULL;
+            entry->active = false;
+        }
+    }
+    for (int i = 0; i < KEYEXPR_CACHE_BUCKETS; i++) {
+        g_keyexpr_cache.buckets[i] = -1;
+    }
+    memset(g_keyexpr_cache.admit, 0, sizeof(g_keyexpr_cache.admit));
+    z_mutex_unlock(z_loan_mut(g_keyexpr_cache.mutex));
+}
+
+// Entry index of key in the publish cache, -1 when it is not cached
+static int publish_cache_find(const char *key, uint64_t hash)
+{
+    int i = g_publish_cache.buckets[hash & (PUBLISH_CACHE_BUCKETS - 1)];
+    while (i >= 0) {
+        publish_cache_entry_t *entry = &g_publish_cache.entries[i];
+        if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+            return i;
+        }
+        i = entry->next;
+    }
+    return -1;
+}
+
+// Free entry, or the least recently used unpinned one, -1 when all are pinned
+static int publish_cache_victim(void)
+{
+    int victim = -1;
+    for (int i = 0; i < PUBLISH_CACHE_SIZE; i++) {
+        publish_cache_entry_t *entry = &g_publish_cache.entries[i];
+        if (!entry->active) {
+            return i;
+        }
+        if (entry->users == 0 &&
+            (victim < 0 || entry->last_used < g_publish_cache.entries[victim].last_used)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+// Remove an active entry from its bucket chain
+static void publish_cache_unlink(int index)
+{
+    publish_cache_entry_t *entry = &g_publish_cache.entries[index];
+    int *link = &g_publish_cache.buckets[entry->hash & (PUBLISH_CACHE_BUCKETS - 1)];
+    while (*link != index) {
+        link = &g_publish_cache.entries[*link].next;
+    }
+    *link = entry->next;
+    entry->active = false;
+}
+
+// Warm publisher for key, pinned until publish_cache_release()
+// NULL when every entry is pinned or key cannot be declared, the caller then
+// falls back to a one-shot put
+static publish_cache_entry_t *publish_cache_acquire(const char *key)
+{
+    size_t len = strlen(key);
+    uint64_t hash = key_hash(key, len);
+    publish_cache_entry_t *found = NULL;
+
+    z_mutex_lock(z_loan_mut(g_publish_cache.mutex));
+    uint64_t now = ++g_publish_cache.clock;
+    int index = publish_cache_find(key, hash);
+    if (index >= 0) {
+        found = &g_publish_cache.entries[index];
+        found->last_used = now;
+        ATOMIC_INCREMENT(&found->users);
+    }
+    z_mutex_unlock(z_loan_mut(g_publish_cache.mutex));
+    if (found != NULL) {
+        return found;
+    }
+
+    // Declared outside the lock so a new key never holds up other publishes
+    z_view_keyexpr_t view;
+    if (z_view_keyexpr_from_str(&view, key) < 0) {
+        return NULL;
+    }
+    char *key_copy = (char *)malloc(len + 1);
+    if (key_copy == NULL) {
+        return NULL;
+    }
+    memcpy(key_copy, key, len + 1);
+    z_owned_publisher_t declared;
+    if (z_declare_publisher(z_loan(session), &declared, z_loan(view), NULL) < 0) {
+        free(key_copy);
+        return NULL;
+    }
+
+    z_owned_publisher_t evicted;
+    bool has_evicted = false;
+
+    z_mutex_lock(z_loan_mut(g_publish_cache.mutex));
+    // Another publish may have cached the key meanwhile
+    index = publish_cache_find(key, hash);
+    if (index < 0) {
+        index = publish_cache_victim();
+        if (index >= 0) {
+            publish_cache_entry_t *entry = &g_publish_cache.entries[index];
+            if (entry->active) {
+                publish_cache_unlink(index);
+                z_take(&evicted, z_move(entry->publisher));
+                free(entry->key);
+                has_evicted = true;
+            }
+            z_take(&entry->publisher, z_move(declared));
+            entry->key = key_copy;
+            entry->hash = hash;
+            entry->users = 0;
+            entry->active = true;
+            int *bucket = &g_publish_cache.buckets[hash & (PUBLISH_CACHE_BUCKETS - 1)];
+            entry->next = *bucket;
+            *bucket = index;
+            key_copy = NULL;
+        }
+    }
+    if (index >= 0) {
+        found = &g_publish_cache.entries[index];
+        found->last_used = now;
+        ATOMIC_INCREMENT(&found->users);
+    }
+    z_mutex_unlock(z_loan_mut(g_publish_cache.mutex));
+
+    // Undeclarations also go out without the lock held
+    if (key_copy != NULL) {
+        z_drop(z_move(declared));
+        free(key_copy);
+    }
+    if (has_evicted) {
+        z_drop(z_move(evicted));
+    }
+    return found;
+}
+
+// Unpin an entry from publish_cache_acquire()
+static void publish_cache_release(publish_cache_entry_t *entry)
+{
+    ATOMIC_DECREMENT(&entry->users);
+}
+
+// Undeclare every zenoh_publish() publisher, must run before the session is dropped
+static void clear_publish_cache(void)
+{
+    z_mutex_lock(z_loan_mut(g_publish_cache.mutex));
+    for (int i = 0; i < PUBLISH_CACHE_SIZE; i++) {
+        publish_cache_entry_t *entry = &g_publish_cache.entries[i];
+        if (entry->active) {
+            z_drop(z_move(entry->publisher));
+            free(entry->key);
+            entry->key = NULL;
+            entry->active = false;
+        }
+    }
+    for (int i = 0; i < PUBLISH_CACHE_BUCKETS; i++) {
+        g_publish_cache.buckets[i] = -1;
+    }
+    z_mutex_unlock(z_loan_mut(g_publish_cache.mutex));
+}
+
+// Key expression of a session put or get, declared when the cache holds it
+typedef struct {
+    z_view_keyexpr_t view;
+    keyexpr_entry_t *cached;
+} keyexpr_ref_t;
+
+// Resolve key through the cache, negative when key is not a valid key expression
+static int keyexpr_ref_init(keyexpr_ref_t *ref, const char *key)
+{
+    ref->cached = keyexpr_cache_acquire(key);
+    if (ref->cached != NULL) {
+        return 0;
+    }
+    return z_view_keyexpr_from_str(&ref->view, key);
+}
+
+static const z_loaned_keyexpr_t *keyexpr_ref_loan(keyexpr_ref_t *ref)
+{
+    return ref->cached != NULL ? z_loan(ref->cached->keyexpr) : z_loan(ref->view);
+}
+
+static void keyexpr_ref_release(keyexpr_ref_t *ref)
+{
+    if (ref->cached != NULL) {
+        keyexpr_cache_release(ref->cached);
+    }
+}
+
+FFI_PLUGIN_EXPORT int zenoh_init(void)
+{
+  z_owned_config_t config;
+
+  z_config_default(&config);
+  // zc_config_from_string(&config, "tcp/localhost:7447");
+  z_owned_session_t s;
+  if (z_open(&s, z_move(config), NULL) < 0)
+  {
+    printf("Failed to open Zenoh session\n");
+    return -1;
+  }
+  z_drop(z_move(s));
+  return 0;
+}
+
+FFI_PLUGIN_EXPORT void zenoh_cleanup(void)
+{
+  zenoh_unsubscribe_all();
+  undeclare_all_queryables();
+  undeclare_all_queriers();
+  undeclare_all_publishers();
+  clear_publish_cache();
+  release_shm_provider();
+  clear_keyexpr_cache();
+  if (session_opened)
+  {
+    z_drop(z_move(session));
+    session_opened = false;
+  }
+  trim_publish_pool();
+}
+
+FFI_PLUGIN_EXPORT int zenoh_open_session(const char* mode, const char* endpoints) {
+    if (session_opened) {
+        printf("Session already opened\n");
+        return 0;
+    }
+
+    z_owned_config_t config;
+    z_config_default(&config);
+
+    zc_config_insert_json5(z_loan_mut(config), Z_CONFIG_MODE_KEY, mode);
+
+// TODO : Fix for macOS network permissions, working on it
+#if defined(__APPLE__) 
+    zc_config_insert_json5(z_loan_mut(config), Z_CONFIG_MULTICAST_SCOUTING_KEY, "false");
+#endif
+
+    if (endpoints) {
+        if (strstr(mode, "peer")) {
+            zc_config_insert_json5(z_loan_mut(config), Z_CONFIG_LISTEN_KEY, endpoints);
+        } else {
+            zc_config_insert_json5(z_loan_mut(config), Z_CONFIG_CONNECT_KEY, endpoints);
+        }
+    }
+
+    if (z_open(&session, z_move(config), NULL) < 0) {
+        printf("Failed to open Zenoh session\n");
+        return -1;
+    }
+
+    printf("Zenoh session opened successfully\n");
+    session_opened = true;
+    return 0;
+}
+
+FFI_PLUGIN_EXPORT void zenoh_close_session(void)
+{
+  zenoh_unsubscribe_all();
+  undeclare_all_queryables();
+  undeclare_all_queriers();
+  undeclare_all_publishers();
+  clear_publish_cache();
+  release_shm_provider();
+  clear_keyexpr_cache();
+  if (session_opened)
+  {
+    z_drop(z_move(session));
+    session_opened = false;
+  }
+}
+
+// Check the QoS fields of options against the zenoh enum ranges
+static bool qos_options_valid(const publisher_options_t *options)
+{
+  if (options->priority != ZENOH_OPTION_DEFAULT &&
+      (options->priority < Z_PRIORITY_REAL_TIME || options->priority > Z_PRIORITY_BACKGROUND))
+  {
+    return false;
+  }
+  if (options->congestion_control != ZENOH_OPTION_DEFAULT &&
+      options->congestion_control != Z_CONGESTION_CONTROL_BLOCK &&
+      options->congestion_control != Z_CONGESTION_CONTROL_DROP)
+  {
+    return false;
+  }
+  return options->reliability == ZENOH_OPTION_DEFAULT || options->reliability == 0 || options->reliability == 1;
+}
+
+// Copy the QoS fields set in options onto z_put_options_t or z_publisher_options_t,
+// which share the field names
+#if defined(Z_FEATURE_UNSTABLE_API)
+#define APPLY_RELIABILITY_OPTION(dst, src) \
+  if ((src)->reliability != ZENOH_OPTION_DEFAULT) (dst).reliability = (z_reliability_t)(src)->reliability;
+#else
+#define APPLY_RELIABILITY_OPTION(dst, src)
+#endif
+
+#define APPLY_QOS_OPTIONS(dst, src) do { \
+  if ((src)->priority != ZENOH_OPTION_DEFAULT) (dst).priority = (z_priority_t)(src)->priority; \
+  if ((src)->congestion_control != ZENOH_OPTION_DEFAULT) (dst).congestion_control = (z_congestion_control_t)(src)->congestion_control; \
+  if ((src)->is_express != ZENOH_OPTION_DEFAULT) (dst).is_express = (src)->is_express != 0; \
+  APPLY_RELIABILITY_OPTION(dst, src) \
+} while (0)
+
+// Copy an optional attachment into bytes for zenoh to own
+// *moved stays NULL when attachment is NULL, otherwise it is set to move bytes
+// Returns -3 for a NULL attachment with a length, -2 when the copy fails
+static int attachment_copy(z_owned_bytes_t *bytes, const uint8_t *attachment, size_t attachment_len,
+                           z_moved_bytes_t **moved)
+{
+  *moved = NULL;
+  if (attachment == NULL)
+  {
+    return attachment_len > 0 ? -3 : 0;
+  }
+  if (z_bytes_copy_from_buf(bytes, attachment, attachment_len) < 0)
+  {
+    return -2;
+  }
+  *moved = z_move(*bytes);
+  return 0;
+}
+
+// Session put of len bytes from data, shared by the string and binary entry points
+static int session_put(const char *key, const uint8_t *data, size_t len,
+                       const uint8_t *attachment, size_t attachment_len, const publisher_options_t *options)
+{
+  if (!session_opened)
+  {
+    return -1;
+  }
+
+  if (key == NULL || (data == NULL && len > 0) || (options != NULL && !qos_options_valid(options)))
+  {
+    return -3;
+  }
+
+  z_put_options_t put_options;
+  z_put_options_default(&put_options);
+
+  z_owned_bytes_t attachment_bytes;
+  int res = attachment_copy(&attachment_bytes, attachment, attachment_len, &put_options.attachment);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  z_owned_encoding_t encoding;
+  if (options != NULL)
+  {
+    APPLY_QOS_OPTIONS(put_options, options);
+    if (options->encoding != NULL)
+    {
+      if (z_encoding_from_str(&encoding, options->encoding) < 0)
+      {
+        if (put_options.attachment != NULL)
+        {
+          z_drop(put_options.attachment);
+        }
+        return -3;
+      }
+      put_options.encoding = z_move(encoding);
+    }
+  }
+
+  z_owned_bytes_t payload;
+  if (z_bytes_copy_from_buf(&payload, data, len) < 0)
+  {
+    if (put_options.encoding != NULL)
+    {
+      z_drop(put_options.encoding);
+    }
+    if (put_options.attachment != NULL)
+    {
+      z_drop(put_options.attachment);
+    }
+    return -2;
+  }
+
+  // Hot keys go out as the numeric id of a cached declaration
+  keyexpr_ref_t keyexpr;
+  if (keyexpr_ref_init(&keyexpr, key) < 0)
+  {
+    z_drop(z_move(payload));
+    if (put_options.encoding != NULL)
+    {
+      z_drop(put_options.encoding);
+    }
+    if (put_options.attachment != NULL)
+    {
+      z_drop(put_options.attachment);
+    }
+    return -1;
+  }
+
+  res = z_put(z_loan(session), keyexpr_ref_loan(&keyexpr), z_move(payload), &put_options);
+  keyexpr_ref_release(&keyexpr);
+  return res < 0 ? -1 : 0;
+}
+
+// Hits and misses of the key expression cache since the library was loaded
+FFI_PLUGIN_EXPORT void zenoh_keyexpr_cache_stats(uint64_t *hits, uint64_t *misses)
+{
+  z_mutex_lock(z_loan_mut(g_keyexpr_cache.mutex));
+  if (hits != NULL)
+  {
+    *hits = g_keyexpr_cache.hits;
+  }
+  if (misses != NULL)
+  {
+    *misses = g_keyexpr_cache.misses;
+  }
+  z_mutex_unlock(z_loan_mut(g_keyexpr_cache.mutex));
+}
+
+FFI_PLUGIN_EXPORT int zenoh_put(const char *key, const char *value)
+{
+  return zenoh_put_with_options(key, value, NULL);
+}
+
+// One-shot put with its own encoding, priority, congestion control and express flag
+FFI_PLUGIN_EXPORT int zenoh_put_with_options(const char *key, const char *value, const publisher_options_t *options)
+{
+  if (value == NULL)
+  {
+    return -3;
+  }
+  return session_put(key, (const uint8_t *)value, strlen(value), NULL, 0, options);
+}
+
+// Binary-safe put of len bytes, the payload may contain NUL bytes
+// attachment may be NULL for none, options NULL for zenoh defaults
+FFI_PLUGIN_EXPORT int zenoh_put_bytes(const char *key, const uint8_t *data, size_t len,
+                                      const uint8_t *attachment, size_t attachment_len,
+                                      const publisher_options_t *options)
+{
+  return session_put(key, data, len, attachment, attachment_len, options);
+}
+
+FFI_PLUGIN_EXPORT int zenoh_declare_publisher(const char *key_expr, const publisher_options_t *options)
+{
+  if (!session_opened)
+  {
+    return -1;
+  }
+
+  if (key_expr == NULL || strlen(key_expr) >= sizeof(g_publishers[0].key_expr) ||
+      (options != NULL && !qos_options_valid(options)))
+  {
+    return -3;
+  }
+
+  z_view_keyexpr_t keyexpr;
+  if (z_view_keyexpr_from_str(&keyexpr, key_expr) < 0)
+  {
+    return -4;
+  }
+
+  // Claim the slot by writing its key, the declaration goes out without the lock
+  z_mutex_lock(z_loan_mut(g_publishers_mutex));
+  int slot_index = find_free_publisher_slot();
+  publisher_t *pub = slot_index == -1 ? NULL : &g_publishers[slot_index];
+  if (pub != NULL)
+  {
+    strncpy(pub->key_expr, key_expr, sizeof(pub->key_expr) - 1);
+    pub->key_expr[sizeof(pub->key_expr) - 1] = '\0';
+  }
+  z_mutex_unlock(z_loan_mut(g_publishers_mutex));
+  if (pub == NULL)
+  {
+    printf("No free publisher slots available\n");
+    return -6;
+  }
+
+  z_publisher_options_t pub_options;
+  z_publisher_options_default(&pub_options);
+
+  int res = 0;
+  z_owned_encoding_t encoding;
+  if (options != NULL)
+  {
+    APPLY_QOS_OPTIONS(pub_options, options);
+    if (options->encoding != NULL)
+    {
+      if (z_encoding_from_str(&encoding, options->encoding) < 0)
+      {
+        res = -3;
+      }
+      else
+      {
+        pub_options.encoding = z_move(encoding);
+      }
+    }
+  }
+
+  if (res == 0 && z_declare_publisher(z_loan(session), &pub->publisher, z_loan(keyexpr), &pub_options) < 0)
+  {
+    printf("Unable to declare publisher for key: %s\n", key_expr);
+    res = -5;
+  }
+
+  z_mutex_lock(z_loan_mut(g_publishers_mutex));
+  if (res == 0)
+  {
+    pub->active = true;
+  }
+  else
+  {
+    pub->key_expr[0] = '\0';
+  }
+  z_mutex_unlock(z_loan_mut(g_publishers_mutex));
+  return res == 0 ? slot_index : res;
+}
+
+// Put payload on a declared publisher, payload and attachment are consumed whatever the outcome
+static int publisher_put_payload(int handle, z_moved_bytes_t *payload, z_publisher_put_options_t *options)
+{
+  int res = -1;
+  z_mutex_lock(z_loan_mut(g_publishers_mutex));
+  bool active = handle >= 0 && handle < MAX_PUBLISHERS && g_publishers[handle].active;
+  if (active && z_publisher_put(z_loan(g_publishers[handle].publisher), payload, options) >= 0)
+  {
+    res = 0;
+  }
+  z_mutex_unlock(z_loan_mut(g_publishers_mutex));
+
+  if (!active)
+  {
+    z_drop(payload);
+    if (options->attachment != NULL)
+    {
+      z_drop(options->attachment);
+    }
+  }
+  return res;
+}
+
+// attachment may be NULL for none
+FFI_PLUGIN_EXPORT int zenoh_publisher_put(int handle, const uint8_t *data, size_t len,
+                                          const uint8_t *attachment, size_t attachment_len)
+{
+  z_publisher_put_options_t put_options;
+  z_publisher_put_options_default(&put_options);
+
+  z_owned_bytes_t attachment_bytes;
+  int res = attachment_copy(&attachment_bytes, attachment, attachment_len, &put_options.attachment);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  z_owned_bytes_t payload;
+  if (z_bytes_copy_from_buf(&payload, data, len) < 0)
+  {
+    if (put_options.attachment != NULL)
+    {
+      z_drop(put_options.attachment);
+    }
+    return -1;
+  }
+
+  return publisher_put_payload(handle, z_move(payload), &put_options);
+}
+
+// Publish count payloads packed in buf, payload i spans [offsets[i], offsets[i + 1])
+// Returns the number of payloads published, stopping at the first failure
+FFI_PLUGIN_EXPORT int zenoh_publish_batch(int handle, const uint8_t *buf, const uint32_t *offsets, size_t count)
+{
+  if (count > 0 && (buf == NULL || offsets == NULL))
+  {
+    return -3;
+  }
+
+  // The whole batch goes out under one lock
+  z_mutex_lock(z_loan_mut(g_publishers_mutex));
+  if (handle < 0 || handle >= MAX_PUBLISHERS || !g_publishers[handle].active)
+  {
+    z_mutex_unlock(z_loan_mut(g_publishers_mutex));
+    return -1;
+  }
+
+  const z_loaned_publisher_t *publisher = z_loan(g_publishers[handle].publisher);
+  z_publisher_put_options_t put_options;
+
+  size_t published = 0;
+  for (; published < count; published++)
+  {
+    uint32_t start = offsets[published];
+    uint32_t end = offsets[published + 1];
+    if (end < start)
+    {
+      break;
+    }
+
+    z_owned_bytes_t payload;
+    if (z_bytes_copy_from_buf(&payload, buf + start, end - start) < 0)
+    {
+      break;
+    }
+
+    z_publisher_put_options_default(&put_options);
+    if (z_publisher_put(publisher, z_move(payload), &put_options) < 0)
+    {
+      break;
+    }
+  }
+  z_mutex_unlock(z_loan_mut(g_publishers_mutex));
+
+  return (int)published;
+}
+
+FFI_PLUGIN_EXPORT void zenoh_undeclare_publisher(int handle)
+{
+  z_mutex_lock(z_loan_mut(g_publishers_mutex));
+  if (handle < 0 || handle >= MAX_PUBLISHERS || !g_publishers[handle].active)
+  {
+    z_mutex_unlock(z_loan_mut(g_publishers_mutex));
+    printf("Publisher %d not found or already undeclared\n", handle);
+    return;
+  }
+
+  z_drop(z_move(g_publishers[handle].publisher));
+  g_publishers[handle].active = false;
+  g_publishers[handle].key_expr[0] = '\0';
+  z_mutex_unlock(z_loan_mut(g_publishers_mutex));
+}
+
+// Take a writable publish buffer of at least size bytes from the plugin pool
+FFI_PLUGIN_EXPORT uint8_t *zenoh_buffer_alloc(size_t size)
+{
+  if (size == 0)
+  {
+    return NULL;
+  }
+  return publish_pool_alloc(size);
+}
+
+// Publish the first len bytes of a zenoh_buffer_alloc() buffer without copying
+// zenoh owns the buffer from here on and hands it back to the pool once sent,
+// it is consumed whatever the outcome
+FFI_PLUGIN_EXPORT int zenoh_publish_buffer(int handle, uint8_t *data, size_t len)
+{
+  if (data == NULL)
+  {
+    return -3;
+  }
+
+  if (len > ((pool_buffer_t *)data - 1)->capacity)
+  {
+    publish_pool_release(data);
+    return -3;
+  }
+
+  z_owned_bytes_t payload;
+  if (z_bytes_from_buf(&payload, data, len, publish_pool_deleter, NULL) < 0)
+  {
+    // The deleter only runs once the bytes exist
+    publish_pool_release(data);
+    return -2;
+  }
+
+  // From here on the deleter returns the buffer, also for an unknown handle
+  z_publisher_put_options_t put_options;
+  z_publisher_put_options_default(&put_options);
+  return publisher_put_payload(handle, z_move(payload), &put_options);
+}
+
+// Return an unpublished zenoh_buffer_alloc() buffer to the pool
+FFI_PLUGIN_EXPORT void zenoh_buffer_free(uint8_t *data)
+{
+  if (data != NULL)
+  {
+    publish_pool_release(data);
+  }
+}
+
+// Whether zenoh_shm_alloc() hands out real shared memory in this build
+FFI_PLUGIN_EXPORT int zenoh_shm_available(void)
+{
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+// Allocate a writable publish buffer of size bytes, *out_data receives its address
+// Shared memory is used when available, the heap otherwise
+// Returns the buffer handle, NULL on failure
+FFI_PLUGIN_EXPORT void *zenoh_shm_alloc(size_t size, uint8_t **out_data)
+{
+  if (size == 0 || out_data == NULL)
+  {
+    return NULL;
+  }
+
+  shm_buffer_t *buf = (shm_buffer_t *)malloc(sizeof(shm_buffer_t));
+  if (buf == NULL)
+  {
+    return NULL;
+  }
+  buf->len = size;
+
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+  // Held across the allocation too, so the session close cannot drop the provider under it
+  z_mutex_lock(z_loan_mut(shm_provider_mutex));
+  if (session_opened && !shm_provider_ready)
+  {
+    shm_provider_ready = z_shm_provider_default_new(&shm_provider, ZENOH_SHM_POOL_SIZE) == Z_OK;
+  }
+  bool allocated = false;
+  if (shm_provider_ready)
+  {
+    // Reclaims and defragments the pool before giving up on shared memory
+    z_buf_layout_alloc_result_t result;
+    z_shm_provider_alloc_gc_defrag(&result, z_loan(shm_provider), size);
+    if (result.status == ZC_BUF_LAYOUT_ALLOC_STATUS_OK)
+    {
+      buf->shm = result.buf;
+      allocated = true;
+    }
+  }
+  z_mutex_unlock(z_loan_mut(shm_provider_mutex));
+  if (allocated)
+  {
+    buf->data = z_shm_mut_data_mut(z_loan_mut(buf->shm));
+    buf->is_shm = true;
+    *out_data = buf->data;
+    return buf;
+  }
+#endif
+
+  buf->data = publish_pool_alloc(size);
+  if (buf->data == NULL)
+  {
+    free(buf);
+    return NULL;
+  }
+  buf->is_shm = false;
+  *out_data = buf->data;
+  return buf;
+}
+
+// Publish a buffer from zenoh_shm_alloc() without copying it
+// The buffer is consumed whatever the outcome
+FFI_PLUGIN_EXPORT int zenoh_publish_shm(int handle, void *shm_buffer)
+{
+  shm_buffer_t *buf = (shm_buffer_t *)shm_buffer;
+  if (buf == NULL)
+  {
+    return -3;
+  }
+
+  z_owned_bytes_t payload;
+  z_result_t res;
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+  if (buf->is_shm)
+  {
+    res = z_bytes_from_shm_mut(&payload, z_move(buf->shm));
+  }
+  else
+#endif
+  {
+    // The pool buffer is handed over to zenoh and returned by the deleter
+    res = z_bytes_from_buf(&payload, buf->data, buf->len, publish_pool_deleter, NULL);
+    if (res < 0)
+    {
+      publish_pool_release(buf->data);
+    }
+  }
+  free(buf);
+  if (res < 0)
+  {
+    return -2;
+  }
+
+  z_publisher_put_options_t put_options;
+  z_publisher_put_options_default(&put_options);
+  return publisher_put_payload(handle, z_move(payload), &put_options);
+}
+
+// Discard a buffer from zenoh_shm_alloc() that will not be published
+FFI_PLUGIN_EXPORT void zenoh_shm_free(void *shm_buffer)
+{
+  shm_buffer_t *buf = (shm_buffer_t *)shm_buffer;
+  if (buf == NULL)
   {
-  case Z_SAMPLE_KIND_PUT:
-    return "PUT";
-  case Z_SAMPLE_KIND_DELETE:
-    return "DELETE";
-  default:
-    return "UNKNOWN";
+    return;
   }
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+  if (buf->is_shm)
+  {
+    z_drop(z_move(buf->shm));
+  }
+  else
+#endif
+  {
+    publish_pool_release(buf->data);
+  }
+  free(buf);
 }
 
-// Find free subscriber slot
-static int find_free_subscriber_slot(void) {
-    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
-        if (!g_subscribers[i].active) {
-            return i;
-        }
+// Wrap an owned query in a handle whose payload view lives until zenoh_query_release()
+static query_handle_t *query_handle_new(z_owned_query_t *query)
+{
+    query_handle_t *handle = (query_handle_t *)malloc(sizeof(query_handle_t));
+    if (handle == NULL) {
+        z_drop(z_move(*query));
+        return NULL;
     }
-    return -1;
+    z_take(&handle->query, z_move(*query));
+
+    handle->owns_slice = false;
+    handle->owns_attachment_slice = false;
+    handle->payload = NULL;
+    handle->payload_len = 0;
+    handle->attachment = NULL;
+    handle->attachment_len = 0;
+    const z_loaned_bytes_t *payload = z_query_payload(z_loan(handle->query));
+    const z_loaned_bytes_t *attachment = z_query_attachment(z_loan(handle->query));
+    if ((payload != NULL &&
+         payload_bind_view(payload, &handle->slice, &handle->owns_slice, &handle->payload, &handle->payload_len) < 0) ||
+        (attachment != NULL &&
+         payload_bind_view(attachment, &handle->attachment_slice, &handle->owns_attachment_slice,
+                           &handle->attachment, &handle->attachment_len) < 0)) {
+        query_handle_free(handle);
+        return NULL;
+    }
+    return handle;
 }
 
-// Find subscriber by ID
-static subscriber_t* find_subscriber_by_id(int subscriber_id) {
-    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
-        if (g_subscribers[i].active && g_subscribers[i].id == subscriber_id) {
-            return &g_subscribers[i];
-        }
+// Queryable handler - takes ownership of the query so Dart can reply later
+// without holding up the zenoh runtime thread
+void query_handler(z_loaned_query_t *query, void *arg)
+{
+    const queryable_context_t *ctx = (const queryable_context_t *)arg;
+
+    z_owned_query_t owned;
+    z_query_take_from_loaned(&owned, query);
+    query_handle_t *handle = query_handle_new(&owned);
+    if (handle == NULL) {
+        printf("Failed to extract query payload\n");
+        return;
     }
-    return NULL;
+
+    z_view_string_t key_string;
+    z_view_string_t parameters;
+    z_keyexpr_as_view_string(z_query_keyexpr(z_loan(handle->query)), &key_string);
+    z_query_parameters(z_loan(handle->query), &parameters);
+
+    // Dart owns the handle from here on
+    ctx->callback(ctx->handle, z_string_data(z_loan(key_string)), z_string_len(z_loan(key_string)),
+                  z_string_data(z_loan(parameters)), z_string_len(z_loan(parameters)),
+                  handle->payload, handle->payload_len, handle->attachment, handle->attachment_len, handle);
 }
 
-// Data handler for subscriber - called when data is received
-void data_handler(z_loaned_sample_t *sample, void *arg)
+// Declare a queryable on key_expr
+// QUERYABLE_MODE_CALLBACK hands every query to callback, QUERYABLE_MODE_RING
+// queues up to capacity queries natively until zenoh_queryable_drain()
+// The queue is a ring so a slow drainer never blocks the zenoh runtime, once
+// full the oldest query is dropped, which ends it without replies
+// Returns the queryable handle
+FFI_PLUGIN_EXPORT int zenoh_declare_queryable(const char *key_expr, int mode, QueryCallback callback, size_t capacity)
 {
-    int subscriber_id = *(int*)arg;
-    subscriber_t* sub = find_subscriber_by_id(subscriber_id);
-    
-    if (sub == NULL || sub->callback == NULL) {
-        printf("Subscriber not found or no callback: %d\n", subscriber_id);
-        return;
+    if (!session_opened) {
+        printf("Session not opened\n");
+        return -1;
+    }
+
+    if (key_expr == NULL || strlen(key_expr) >= sizeof(g_queryables[0].key_expr) ||
+        (mode == QUERYABLE_MODE_CALLBACK && callback == NULL) ||
+        (mode == QUERYABLE_MODE_RING && capacity == 0) ||
+        (mode != QUERYABLE_MODE_CALLBACK && mode != QUERYABLE_MODE_RING)) {
+        printf("Invalid arguments\n");
+        return -3;
+    }
+
+    z_view_keyexpr_t keyexpr;
+    if (z_view_keyexpr_from_str(&keyexpr, key_expr) < 0) {
+        printf("Invalid key expression: %s\n", key_expr);
+        return -4;
+    }
+
+    queryable_context_t *ctx = NULL;
+    if (mode == QUERYABLE_MODE_CALLBACK) {
+        ctx = (queryable_context_t *)malloc(sizeof(queryable_context_t));
+        if (ctx == NULL) {
+            return -2;
+        }
+    }
+
+    // Claim the slot by writing its key, the declaration goes out without the lock
+    z_mutex_lock(z_loan_mut(g_queryables_mutex));
+    int slot_index = find_free_queryable_slot();
+    queryable_t *q = slot_index == -1 ? NULL : &g_queryables[slot_index];
+    if (q != NULL) {
+        strncpy(q->key_expr, key_expr, sizeof(q->key_expr) - 1);
+        q->key_expr[sizeof(q->key_expr) - 1] = '\0';
+    }
+    z_mutex_unlock(z_loan_mut(g_queryables_mutex));
+    if (q == NULL) {
+        free(ctx);
+        printf("No free queryable slots available\n");
+        return -6;
+    }
+
+    q->mode = mode;
+    q->pending = NULL;
+    z_owned_closure_query_t closure;
+    if (mode == QUERYABLE_MODE_RING) {
+        z_ring_channel_query_new(&closure, &q->ring, capacity);
+    } else {
+        ctx->callback = callback;
+        ctx->handle = slot_index;
+        z_closure_query(&closure, query_handler, free, ctx);
+    }
+
+    bool declared = z_declare_queryable(z_loan(session), &q->queryable, z_loan(keyexpr), z_move(closure), NULL) >= 0;
+    if (!declared) {
+        printf("Unable to declare queryable for key: %s\n", key_expr);
+        if (mode == QUERYABLE_MODE_RING) {
+            z_drop(z_move(q->ring));
+        }
+    }
+
+    z_mutex_lock(z_loan_mut(g_queryables_mutex));
+    if (declared) {
+        q->active = true;
+    } else {
+        q->key_expr[0] = '\0';
+    }
+    z_mutex_unlock(z_loan_mut(g_queryables_mutex));
+    if (!declared) {
+        return -5;
     }
 
-    // Extract key
+    printf("Queryable successfully declared on '%s' with handle: %d\n", key_expr, slot_index);
+    return slot_index;
+}
+
+// Serialize one query as a query_record_t, returns the record size or 0 if it does not fit
+static size_t write_query_record(query_handle_t *handle, uint8_t *out, size_t space)
+{
     z_view_string_t key_string;
-    z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_string);
+    z_view_string_t parameters;
+    z_keyexpr_as_view_string(z_query_keyexpr(z_loan(handle->query)), &key_string);
+    z_query_parameters(z_loan(handle->query), &parameters);
+
+    query_record_t record;
+    record.key_len = (uint32_t)z_string_len(z_loan(key_string));
+    record.parameters_len = (uint32_t)z_string_len(z_loan(parameters));
+    record.payload_len = (uint32_t)handle->payload_len;
+    record.query_handle = (uint64_t)(uintptr_t)handle;
+    record.attachment_len = (uint32_t)handle->attachment_len;
+
+    size_t size = (sizeof(query_record_t) + record.key_len + record.parameters_len + record.payload_len +
+                   record.attachment_len + 7) & ~(size_t)7;
+    if (size > space) {
+        return 0;
+    }
+    record.size = (uint32_t)size;
+
+    memcpy(out, &record, sizeof(query_record_t));
+    out += sizeof(query_record_t);
+    memcpy(out, z_string_data(z_loan(key_string)), record.key_len);
+    out += record.key_len;
+    memcpy(out, z_string_data(z_loan(parameters)), record.parameters_len);
+    out += record.parameters_len;
+    if (record.payload_len > 0) {
+        memcpy(out, handle->payload, record.payload_len);
+        out += record.payload_len;
+    }
+    if (record.attachment_len > 0) {
+        memcpy(out, handle->attachment, record.attachment_len);
+    }
+    return size;
+}
 
-    // Extract payload
-    z_owned_string_t payload_string;
-    if (z_bytes_to_string(z_sample_payload(sample), &payload_string) < 0) {
-        printf("Failed to extract payload\n");
-        return;
+// Move up to max_queries queued queries of a ring queryable into out_buf as
+// query_record_t entries, each carrying a handle Dart must release
+// Returns the number of records written, or -7 if the next query needs a bigger buffer
+FFI_PLUGIN_EXPORT int zenoh_queryable_drain(int handle, uint8_t *out_buf, size_t buf_size, int max_queries)
+{
+    if (out_buf == NULL) {
+        return -3;
     }
 
-    // Get sample kind
-    const char *kind = kind_to_str(z_sample_kind(sample));
+    z_mutex_lock(z_loan_mut(g_queryables_mutex));
+    if (handle < 0 || handle >= MAX_QUERYABLES || !g_queryables[handle].active ||
+        g_queryables[handle].mode != QUERYABLE_MODE_RING) {
+        z_mutex_unlock(z_loan_mut(g_queryables_mutex));
+        return -1;
+    }
 
-    // Extract attachment if exists
-    const z_loaned_bytes_t *attachment = z_sample_attachment(sample);
-    char *attachment_str = "";  // Default to empty string
-    z_owned_string_t attachment_string;
+    queryable_t *q = &g_queryables[handle];
+    int count = 0;
+    size_t offset = 0;
+    while (count < max_queries) {
+        query_handle_t *query = q->pending;
+        q->pending = NULL;
+        if (query == NULL) {
+            z_owned_query_t owned;
+            if (z_ring_handler_query_try_recv(z_loan(q->ring), &owned) != Z_OK) {
+                break;
+            }
+            query = query_handle_new(&owned);
+            if (query == NULL) {
+                continue;
+            }
+        }
 
-    // Create null-terminated strings for callback
-    size_t key_len = z_string_len(z_loan(key_string));
-    size_t payload_len = z_string_len(z_loan(payload_string));
+        size_t size = write_query_record(query, out_buf + offset, buf_size - offset);
+        if (size == 0) {
+            // Keep it for the next drain
+            q->pending = query;
+            break;
+        }
+        offset += size;
+        count++;
+    }
 
-    char *key_buf = (char *)malloc(key_len + 1);
-    char *payload_buf = (char *)malloc(payload_len + 1);
-    char *kind_buf = strdup(kind);  // Make a copy of kind string too
+    int res = (count == 0 && q->pending != NULL) ? -7 : count;
+    z_mutex_unlock(z_loan_mut(g_queryables_mutex));
+    return res;
+}
 
-    if (key_buf && payload_buf && kind_buf) {
-        memcpy(key_buf, z_string_data(z_loan(key_string)), key_len);
-        key_buf[key_len] = '\0';
+// Reply to a query, may be called from any thread until the handle is released
+// The reply is sent on the key expression of the query
+FFI_PLUGIN_EXPORT int zenoh_query_reply(void *query_handle, const uint8_t *payload, size_t len, const char *encoding,
+                                        const uint8_t *attachment, size_t attachment_len)
+{
+    query_handle_t *handle = (query_handle_t *)query_handle;
+    if (handle == NULL || (payload == NULL && len > 0)) {
+        return -3;
+    }
 
-        memcpy(payload_buf, z_string_data(z_loan(payload_string)), payload_len);
-        payload_buf[payload_len] = '\0';
+    z_query_reply_options_t options;
+    z_query_reply_options_default(&options);
 
-        // Logs for debugging
-        // printf("Calling callback for subscriber %d - Key: %s, Value: %s, Kind: %s\n", 
-        //        subscriber_id, key_buf, payload_buf, kind_buf);
+    z_owned_bytes_t attachment_bytes;
+    int res = attachment_copy(&attachment_bytes, attachment, attachment_len, &options.attachment);
+    if (res < 0) {
+        return res;
+    }
 
-        // CRITICAL: Pass ownership to Dart
-        // Dart MUST free these strings using zenoh_free_string()
-        sub->callback(key_buf, payload_buf, kind_buf, attachment_str, subscriber_id);
+    z_owned_bytes_t bytes;
+    if (z_bytes_copy_from_buf(&bytes, payload, len) < 0) {
+        if (options.attachment != NULL) {
+            z_drop(options.attachment);
+        }
+        return -2;
+    }
 
-        // DO NOT FREE HERE - Dart will free them!
-        // The strings are now owned by Dart side
-    } else {
-        // Allocation failed - clean up
-        if (key_buf) free(key_buf);
-        if (payload_buf) free(payload_buf);
-        if (kind_buf) free(kind_buf);
+    z_owned_encoding_t reply_encoding;
+    if (encoding != NULL) {
+        if (z_encoding_from_str(&reply_encoding, encoding) < 0) {
+            z_drop(z_move(bytes));
+            if (options.attachment != NULL) {
+                z_drop(options.attachment);
+            }
+            return -3;
+        }
+        options.encoding = z_move(reply_encoding);
     }
 
-    // Cleanup Zenoh owned strings
-    if (attachment != NULL && z_bytes_len(attachment) > 0) {
-        z_drop(z_move(attachment_string));
+    const z_loaned_query_t *query = z_loan(handle->query);
+    if (z_query_reply(query, z_query_keyexpr(query), z_move(bytes), &options) < 0) {
+        return -1;
     }
-    z_drop(z_move(payload_string));
+    return 0;
 }
 
-// Reply callback function for zenoh_get
-void reply_callback(z_loaned_reply_t *reply, void *context)
+// Release a query handle, which completes the query for the querier
+FFI_PLUGIN_EXPORT void zenoh_query_release(void *query_handle)
 {
-  if (z_reply_is_ok(reply))
-  {
-    const z_loaned_sample_t *sample = z_reply_ok(reply);
-    const z_loaned_bytes_t *payload = z_sample_payload(sample);
+    if (query_handle != NULL) {
+        query_handle_free((query_handle_t *)query_handle);
+    }
+}
 
-    if (payload)
-    {
-      size_t len = z_bytes_len(payload);
-      last_received_value = (char *)malloc(len + 1);
-      if (last_received_value)
-      {
-        z_bytes_reader_t reader = z_bytes_get_reader(payload);
-        size_t bytes_read = z_bytes_reader_read(&reader, (uint8_t *)last_received_value, len);
-        last_received_value[bytes_read] = '\0';
-        reply_received = true;
-      }
+FFI_PLUGIN_EXPORT void zenoh_undeclare_queryable(int handle)
+{
+    z_mutex_lock(z_loan_mut(g_queryables_mutex));
+    if (handle < 0 || handle >= MAX_QUERYABLES || !g_queryables[handle].active) {
+        z_mutex_unlock(z_loan_mut(g_queryables_mutex));
+        printf("Queryable %d not found or already undeclared\n", handle);
+        return;
     }
-  }
+
+    printf("Queryable %d closed for key: %s\n", handle, g_queryables[handle].key_expr);
+    release_queryable_slot(handle);
+    z_mutex_unlock(z_loan_mut(g_queryables_mutex));
 }
 
-// Zenoh-C function implementations
-FFI_PLUGIN_EXPORT int zenoh_init(void)
+// Keyed publish - reuses a warm publisher from the publish cache for this key,
+// the least recently used one is evicted for a new key
+FFI_PLUGIN_EXPORT int zenoh_publish(const char *key, const char *value)
 {
-  z_owned_config_t config;
+  if (!session_opened || key == NULL || value == NULL)
+  {
+    return -1;
+  }
 
-  z_config_default(&config);
-  // zc_config_from_string(&config, "tcp/localhost:7447");
-  z_owned_session_t s;
-  if (z_open(&s, z_move(config), NULL) < 0)
+  publish_cache_entry_t *cached = publish_cache_acquire(key);
+  if (cached == NULL)
   {
-    printf("Failed to open Zenoh session\n");
+    // No cached publisher is free for this key, send the value as a one-shot put
+    return session_put(key, (const uint8_t *)value, strlen(value), NULL, 0, NULL) < 0 ? -1 : 0;
+  }
+
+  z_owned_bytes_t payload;
+  if (z_bytes_copy_from_buf(&payload, (const uint8_t *)value, strlen(value)) < 0)
+  {
+    publish_cache_release(cached);
     return -1;
   }
-  z_drop(z_move(s));
-  return 0;
+
+  z_publisher_put_options_t put_options;
+  z_publisher_put_options_default(&put_options);
+
+  int res = z_publisher_put(z_loan(cached->publisher), z_move(payload), &put_options);
+  publish_cache_release(cached);
+  return res < 0 ? -1 : 0;
 }
 
-FFI_PLUGIN_EXPORT void zenoh_cleanup(void)
+FFI_PLUGIN_EXPORT char *zenoh_get(const char *key)
 {
-  zenoh_unsubscribe_all();
-  if (session_opened)
+  if (!session_opened)
   {
-    z_drop(z_move(session));
-    session_opened = false;
+    return NULL;
   }
-  if (publisher_declared)
+
+  keyexpr_ref_t keyexpr;
+  if (keyexpr_ref_init(&keyexpr, key) < 0)
   {
-    z_drop(z_move(global_publisher));
-    publisher_declared = false;
+    return NULL;
   }
-}
-
-FFI_PLUGIN_EXPORT int zenoh_open_session(const char* mode, const char* endpoints) {
-    if (session_opened) {
-        printf("Session already opened\n");
-        return 0;
-    }
 
-    z_owned_config_t config;
-    z_config_default(&config);
+  // Shared by this call and the reply closure, freed by whichever finishes last
+  get_sync_context_t *ctx = (get_sync_context_t *)calloc(1, sizeof(get_sync_context_t));
+  if (ctx == NULL)
+  {
+    keyexpr_ref_release(&keyexpr);
+    return NULL;
+  }
+  z_mutex_init(&ctx->mutex);
+  z_condvar_init(&ctx->condvar);
+  ctx->refs = 2;
 
-    zc_config_insert_json5(z_loan_mut(config), Z_CONFIG_MODE_KEY, mode);
+  z_owned_closure_reply_t closure;
+  z_closure_reply(&closure, reply_callback, reply_dropper, ctx);
 
-// TODO : Fix for macOS network permissions, working on it
-#if defined(__APPLE__) 
-    zc_config_insert_json5(z_loan_mut(config), Z_CONFIG_MULTICAST_SCOUTING_KEY, "false");
-#endif
+  z_get_options_t get_options;
+  z_get_options_default(&get_options);
+  get_options.timeout_ms = 5000;
 
-    if (endpoints) {
-        if (strstr(mode, "peer")) {
-            zc_config_insert_json5(z_loan_mut(config), Z_CONFIG_LISTEN_KEY, endpoints);
-        } else {
-            zc_config_insert_json5(z_loan_mut(config), Z_CONFIG_CONNECT_KEY, endpoints);
-        }
-    }
+  // A failed z_get still drops the closure, which marks the context done
+  z_get(z_loan(session), keyexpr_ref_loan(&keyexpr), "", z_move(closure), &get_options);
+  keyexpr_ref_release(&keyexpr);
 
-    if (z_open(&session, z_move(config), NULL) < 0) {
-        printf("Failed to open Zenoh session\n");
-        return -1;
-    }
+  z_mutex_lock(z_loan_mut(ctx->mutex));
+  while (ctx->value == NULL && !ctx->done)
+  {
+    z_condvar_wait(z_loan(ctx->condvar), z_loan_mut(ctx->mutex));
+  }
+  char *result = ctx->value;
+  ctx->value = NULL;
+  ctx->taken = true;
+  z_mutex_unlock(z_loan_mut(ctx->mutex));
 
-    printf("Zenoh session opened successfully\n");
-    session_opened = true;
-    return 0;
+  get_sync_context_release(ctx);
+  return result;
 }
 
-FFI_PLUGIN_EXPORT void zenoh_close_session(void)
+// Non-blocking get - replies and a final done marker are delivered to callback
+FFI_PLUGIN_EXPORT int zenoh_get_async(const char *key, const char *parameters, uint64_t timeout_ms,
+                                      const uint8_t *attachment, size_t attachment_len,
+                                      GetReplyCallback callback, int request_id)
 {
-  zenoh_unsubscribe_all();
-  if (session_opened)
+  if (!session_opened)
   {
-    z_drop(z_move(session));
-    session_opened = false;
+    return -1;
+  }
+
+  if (key == NULL || callback == NULL)
+  {
+    return -3;
+  }
+
+  z_get_options_t get_options;
+  z_get_options_default(&get_options);
+  if (timeout_ms > 0)
+  {
+    get_options.timeout_ms = timeout_ms;
+  }
+
+  z_owned_bytes_t attachment_bytes;
+  int res = attachment_copy(&attachment_bytes, attachment, attachment_len, &get_options.attachment);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  keyexpr_ref_t keyexpr;
+  if (keyexpr_ref_init(&keyexpr, key) < 0)
+  {
+    if (get_options.attachment != NULL)
+    {
+      z_drop(get_options.attachment);
+    }
+    return -4;
   }
+
+  get_context_t *ctx = (get_context_t *)malloc(sizeof(get_context_t));
+  if (ctx == NULL)
+  {
+    keyexpr_ref_release(&keyexpr);
+    if (get_options.attachment != NULL)
+    {
+      z_drop(get_options.attachment);
+    }
+    return -2;
+  }
+  ctx->callback = callback;
+  ctx->request_id = request_id;
+
+  // The dropper owns ctx from here on, even if z_get fails
+  z_owned_closure_reply_t closure;
+  z_closure_reply(&closure, async_reply_handler, async_reply_dropper, ctx);
+
+  res = z_get(z_loan(session), keyexpr_ref_loan(&keyexpr), parameters ? parameters : "", z_move(closure), &get_options);
+  keyexpr_ref_release(&keyexpr);
+  return res < 0 ? -5 : 0;
 }
 
-FFI_PLUGIN_EXPORT int zenoh_put(const char *key, const char *value)
+// Declare a querier on key_expr for repeated gets on the same key
+// target is a z_query_target_t, consolidation a z_consolidation_mode_t,
+// timeout_ms 0 keeps the zenoh default
+// Returns the querier handle
+FFI_PLUGIN_EXPORT int zenoh_declare_querier(const char *key_expr, int target, int consolidation, uint64_t timeout_ms)
 {
   if (!session_opened)
   {
     return -1;
   }
 
+  if (key_expr == NULL || strlen(key_expr) >= sizeof(g_queriers[0].key_expr) ||
+      target < Z_QUERY_TARGET_BEST_MATCHING || target > Z_QUERY_TARGET_ALL_COMPLETE ||
+      consolidation < Z_CONSOLIDATION_MODE_AUTO || consolidation > Z_CONSOLIDATION_MODE_LATEST)
+  {
+    return -3;
+  }
+
   z_view_keyexpr_t keyexpr;
-  if (z_view_keyexpr_from_str(&keyexpr, key) < 0)
+  if (z_view_keyexpr_from_str(&keyexpr, key_expr) < 0)
   {
-    return -1;
+    return -4;
   }
 
-  z_owned_bytes_t payload;
-  z_bytes_copy_from_str(&payload, value);
+  // Claim the slot by writing its key, the declaration goes out without the lock
+  z_mutex_lock(z_loan_mut(g_queriers_mutex));
+  int slot_index = find_free_querier_slot();
+  querier_t *querier = slot_index == -1 ? NULL : &g_queriers[slot_index];
+  if (querier != NULL)
+  {
+    strncpy(querier->key_expr, key_expr, sizeof(querier->key_expr) - 1);
+    querier->key_expr[sizeof(querier->key_expr) - 1] = '\0';
+  }
+  z_mutex_unlock(z_loan_mut(g_queriers_mutex));
+  if (querier == NULL)
+  {
+    printf("No free querier slots available\n");
+    return -6;
+  }
 
-  z_put_options_t options;
-  z_put_options_default(&options);
+  z_querier_options_t querier_options;
+  z_querier_options_default(&querier_options);
+  querier_options.target = (z_query_target_t)target;
+  querier_options.consolidation.mode = (z_consolidation_mode_t)consolidation;
+  if (timeout_ms > 0)
+  {
+    querier_options.timeout_ms = timeout_ms;
+  }
 
-  if (z_put(z_loan(session), z_loan(keyexpr), z_move(payload), &options) < 0)
+  bool declared = z_declare_querier(z_loan(session), &querier->querier, z_loan(keyexpr), &querier_options) >= 0;
+  if (!declared)
   {
-    return -1;
+    printf("Unable to declare querier for key: %s\n", key_expr);
   }
 
-  return 0;
+  z_mutex_lock(z_loan_mut(g_queriers_mutex));
+  if (declared)
+  {
+    querier->active = true;
+  }
+  else
+  {
+    querier->key_expr[0] = '\0';
+  }
+  z_mutex_unlock(z_loan_mut(g_queriers_mutex));
+  return declared ? slot_index : -5;
 }
 
-FFI_PLUGIN_EXPORT int zenoh_publish(const char *key, const char *value)
+// Async get through a declared querier, replies are delivered like zenoh_get_async()
+// payload may be NULL to send the query without one
+FFI_PLUGIN_EXPORT int zenoh_querier_get(int handle, const char *parameters, const uint8_t *payload, size_t payload_len,
+                                        const uint8_t *attachment, size_t attachment_len,
+                                        GetReplyCallback callback, int request_id)
 {
-  if (!session_opened)
+  if (handle < 0 || handle >= MAX_QUERIERS)
   {
     return -1;
   }
 
-  if (!publisher_declared || strcmp(current_publisher_key, key) != 0)
+  if (callback == NULL || (payload == NULL && payload_len > 0))
+  {
+    return -3;
+  }
+
+  z_querier_get_options_t get_options;
+  z_querier_get_options_default(&get_options);
+
+  z_owned_bytes_t attachment_bytes;
+  int res = attachment_copy(&attachment_bytes, attachment, attachment_len, &get_options.attachment);
+  if (res < 0)
+  {
+    return res;
+  }
+
+  z_owned_bytes_t bytes;
+  if (payload != NULL)
   {
-    if (publisher_declared)
+    if (z_bytes_copy_from_buf(&bytes, payload, payload_len) < 0)
     {
-      z_drop(z_move(global_publisher));
-      publisher_declared = false;
+      if (get_options.attachment != NULL)
+      {
+        z_drop(get_options.attachment);
+      }
+      return -2;
     }
+    get_options.payload = z_move(bytes);
+  }
 
-    z_view_keyexpr_t keyexpr;
-    if (z_view_keyexpr_from_str(&keyexpr, key) < 0)
+  get_context_t *ctx = (get_context_t *)malloc(sizeof(get_context_t));
+  if (ctx == NULL)
+  {
+    if (payload != NULL)
+    {
+      z_drop(z_move(bytes));
+    }
+    if (get_options.attachment != NULL)
     {
-      return -1;
+      z_drop(get_options.attachment);
     }
+    return -2;
+  }
+  ctx->callback = callback;
+  ctx->request_id = request_id;
 
-    z_publisher_options_t pub_options;
-    z_publisher_options_default(&pub_options);
+  // The dropper owns ctx from here on, even if z_querier_get fails
+  z_owned_closure_reply_t closure;
+  z_closure_reply(&closure, async_reply_handler, async_reply_dropper, ctx);
+
+  // Only the get itself runs under the lock
+  z_mutex_lock(z_loan_mut(g_queriers_mutex));
+  bool active = g_queriers[handle].active;
+  if (active)
+  {
+    res = z_querier_get(z_loan(g_queriers[handle].querier), parameters ? parameters : "", z_move(closure),
+                        &get_options) < 0 ? -5 : 0;
+  }
+  z_mutex_unlock(z_loan_mut(g_queriers_mutex));
 
-    if (z_declare_publisher(z_loan(session), &global_publisher, z_loan(keyexpr), &pub_options) < 0)
+  if (!active)
+  {
+    // The dropper ends the request, as it does for a failed get
+    z_drop(z_move(closure));
+    if (get_options.payload != NULL)
+    {
+      z_drop(get_options.payload);
+    }
+    if (get_options.attachment != NULL)
     {
-      return -1;
+      z_drop(get_options.attachment);
     }
+    return -1;
+  }
+
+  return res;
+}
 
-    strncpy(current_publisher_key, key, sizeof(current_publisher_key) - 1);
-    publisher_declared = true;
+FFI_PLUGIN_EXPORT void zenoh_undeclare_querier(int handle)
+{
+  z_mutex_lock(z_loan_mut(g_queriers_mutex));
+  if (handle < 0 || handle >= MAX_QUERIERS || !g_queriers[handle].active)
+  {
+    z_mutex_unlock(z_loan_mut(g_queriers_mutex));
+    printf("Querier %d not found or already undeclared\n", handle);
+    return;
   }
 
-  z_owned_bytes_t payload;
-  z_bytes_copy_from_str(&payload, value);
+  z_drop(z_move(g_queriers[handle].querier));
+  g_queriers[handle].active = false;
+  g_queriers[handle].key_expr[0] = '\0';
+  z_mutex_unlock(z_loan_mut(g_queriers_mutex));
+}
+
+// Append one reply as a reply_record_t followed by its key, payload and encoding
+static int append_reply_record(byte_buffer_t *buf, const z_loaned_reply_t *reply)
+{
+  reply_record_t record = {0};
+  const z_loaned_bytes_t *payload;
+  z_view_string_t key_string;
+  z_owned_string_t encoding_string;
+  bool has_sample = z_reply_is_ok(reply);
+
+  if (has_sample)
+  {
+    const z_loaned_sample_t *sample = z_reply_ok(reply);
+    payload = z_sample_payload(sample);
+    z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_string);
+    z_encoding_to_string(z_sample_encoding(sample), &encoding_string);
+    record.key_len = (uint32_t)z_string_len(z_loan(key_string));
+    record.encoding_len = (uint32_t)z_string_len(z_loan(encoding_string));
 
-  z_publisher_put_options_t put_options;
-  z_publisher_put_options_default(&put_options);
+    const z_timestamp_t *timestamp = z_sample_timestamp(sample);
+    record.timestamp = timestamp ? z_timestamp_ntp64_time(timestamp) : 0;
+  }
+  else
+  {
+    const z_loaned_reply_err_t *err = z_reply_err(reply);
+    payload = z_reply_err_payload(err);
+    z_encoding_to_string(z_reply_err_encoding(err), &encoding_string);
+    record.encoding_len = (uint32_t)z_string_len(z_loan(encoding_string));
+    record.is_error = 1;
+  }
+  record.payload_len = (uint32_t)z_bytes_len(payload);
 
-  if (z_publisher_put(z_loan(global_publisher), z_move(payload), &put_options) < 0)
+  size_t body_len = record.key_len + record.payload_len + record.encoding_len;
+  size_t padded_len = (sizeof(reply_record_t) + body_len + 7) & ~(size_t)7;
+  uint8_t *out = byte_buffer_grow(buf, padded_len);
+  if (out == NULL)
   {
+    z_drop(z_move(encoding_string));
     return -1;
   }
 
+  memcpy(out, &record, sizeof(reply_record_t));
+  out += sizeof(reply_record_t);
+  if (has_sample)
+  {
+    memcpy(out, z_string_data(z_loan(key_string)), record.key_len);
+    out += record.key_len;
+  }
+  z_bytes_reader_t reader = z_bytes_get_reader(payload);
+  out += z_bytes_reader_read(&reader, out, record.payload_len);
+  memcpy(out, z_string_data(z_loan(encoding_string)), record.encoding_len);
+
+  z_drop(z_move(encoding_string));
   return 0;
 }
 
-FFI_PLUGIN_EXPORT char *zenoh_get(const char *key)
+// Collect every reply of a query into one buffer of reply_record_t entries
+// Returns the number of replies, *out_buf must be freed with zenoh_free_buffer()
+FFI_PLUGIN_EXPORT int zenoh_get_all(const char *key, const char *parameters, uint64_t timeout_ms,
+                                    uint8_t **out_buf, size_t *out_size)
 {
   if (!session_opened)
   {
-    return NULL;
+    return -1;
   }
 
-  reply_received = false;
-  if (last_received_value)
+  if (key == NULL || out_buf == NULL || out_size == NULL)
   {
-    free(last_received_value);
-    last_received_value = NULL;
+    return -3;
   }
 
+  *out_buf = NULL;
+  *out_size = 0;
+
   z_view_keyexpr_t keyexpr;
   if (z_view_keyexpr_from_str(&keyexpr, key) < 0)
   {
-    return NULL;
+    return -4;
   }
 
+  z_owned_fifo_handler_reply_t handler;
   z_owned_closure_reply_t closure;
-  z_closure_reply(&closure, reply_callback, NULL, NULL);
+  z_fifo_channel_reply_new(&closure, &handler, 16);
 
   z_get_options_t get_options;
   z_get_options_default(&get_options);
-  get_options.timeout_ms = 5000;
-
-  z_moved_closure_reply_t moved_closure = {closure};
-  if (z_get(z_loan(session), z_loan(keyexpr), "", &moved_closure, &get_options) < 0)
+  if (timeout_ms > 0)
   {
-    return NULL;
+    get_options.timeout_ms = timeout_ms;
   }
 
-  int max_wait_ms = 6000;
-  int wait_step_ms = 100;
+  if (z_get(z_loan(session), z_loan(keyexpr), parameters ? parameters : "", z_move(closure), &get_options) < 0)
+  {
+    z_drop(z_move(handler));
+    return -5;
+  }
 
-  for (int i = 0; i < max_wait_ms / wait_step_ms; i++)
+  // recv blocks until the next reply and fails once the query is finished
+  byte_buffer_t buf = {0};
+  int count = 0;
+  int result = 0;
+  z_owned_reply_t reply;
+  while (z_fifo_handler_reply_recv(z_loan(handler), &reply) == Z_OK)
   {
-    if (reply_received)
+    if (result == 0 && append_reply_record(&buf, z_loan(reply)) == 0)
     {
-      break;
+      count++;
     }
-#if _WIN32
-    Sleep(wait_step_ms);
-#else
-    usleep(wait_step_ms * 1000);
-#endif
+    else
+    {
+      // Keep draining so the channel can shut down
+      result = -2;
+    }
+    z_drop(z_move(reply));
   }
+  z_drop(z_move(handler));
 
-  if (reply_received && last_received_value)
+  if (result < 0)
   {
-    return strdup(last_received_value);
+    free(buf.data);
+    return result;
   }
 
-  return NULL;
+  *out_buf = buf.data;
+  *out_size = buf.len;
+  return count;
 }
 
 FFI_PLUGIN_EXPORT void zenoh_free_string(char *str)
@@ -341,6 +2619,20 @@ FFI_PLUGIN_EXPORT void zenoh_free_string(char *str)
   }
 }
 
+FFI_PLUGIN_EXPORT void zenoh_free_buffer(uint8_t *buf)
+{
+  free(buf);
+}
+
+// Return a subscriber callback buffer to the slab it came from
+FFI_PLUGIN_EXPORT void zenoh_release(void *buffer)
+{
+  if (buffer)
+  {
+    slab_release(buffer);
+  }
+}
+
 FFI_PLUGIN_EXPORT char *zenoh_get_with_handler(const char *key)
 {
   if (!session_opened)
@@ -369,63 +2661,44 @@ FFI_PLUGIN_EXPORT char *zenoh_get_with_handler(const char *key)
     return NULL;
   }
 
+  // recv blocks until the next reply and fails once the query is finished
   z_owned_reply_t reply;
   char *result = NULL;
-
-  int max_wait_ms = 6000;
-  int wait_step_ms = 100;
-
-  for (int i = 0; i < max_wait_ms / wait_step_ms; i++)
+  while (result == NULL && z_fifo_handler_reply_recv(z_loan(handler), &reply) == Z_OK)
   {
-    if (z_fifo_handler_reply_try_recv(z_loan(handler), &reply) == Z_OK)
+    if (z_reply_is_ok(z_loan(reply)))
     {
-      if (z_reply_is_ok(z_loan(reply)))
-      {
-        const z_loaned_sample_t *sample = z_reply_ok(z_loan(reply));
-        const z_loaned_bytes_t *payload = z_sample_payload(sample);
-
-        if (payload)
-        {
-          size_t len = z_bytes_len(payload);
-          result = (char *)malloc(len + 1);
-          if (result)
-          {
-            z_bytes_reader_t reader = z_bytes_get_reader(payload);
-            size_t bytes_read = z_bytes_reader_read(&reader, (uint8_t *)result, len);
-            result[bytes_read] = '\0';
-          }
-        }
-      }
-      z_drop(z_move(reply));
-      break;
+      result = payload_to_cstr(z_sample_payload(z_reply_ok(z_loan(reply))));
     }
-#if _WIN32
-    Sleep(wait_step_ms);
-#else
-    usleep(wait_step_ms * 1000);
-#endif
+    z_drop(z_move(reply));
   }
 
   z_drop(z_move(handler));
   return result;
 }
 
-// FIXED MULTIPLE SUBSCRIBER IMPLEMENTATION
-FFI_PLUGIN_EXPORT int zenoh_subscribe(const char *key_expr, SubscriberCallback callback)
+// Claim a free slot and declare a subscriber routing samples through handler
+// Pull subscribers pass their channel instead of a handler
+static int declare_subscriber_slot(const char *key_expr, SubscriberCallback callback,
+                                   SubscriberBytesCallback bytes_callback,
+                                   void (*handler)(z_loaned_sample_t *, void *),
+                                   pull_channel_t *pull, const Dart_Port *ports, int port_count)
 {
-    if (!session_opened) {
-        printf("Session not opened\n");
-        return -1;
+    // Create key expression
+    z_view_keyexpr_t keyexpr;
+    if (z_view_keyexpr_from_str(&keyexpr, key_expr) < 0) {
+        printf("Invalid key expression: %s\n", key_expr);
+        free(pull);
+        return -4;
     }
 
-    if (key_expr == NULL || callback == NULL) {
-        printf("Invalid arguments\n");
-        return -3;
-    }
+    z_mutex_lock(z_loan_mut(g_subscribers.mutex));
 
     // Find free slot
-    int slot_index = find_free_subscriber_slot();
+    int slot_index = alloc_subscriber_slot();
     if (slot_index == -1) {
+        z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+        free(pull);
         printf("No free subscriber slots available\n");
         return -6;
     }
@@ -433,77 +2706,545 @@ FFI_PLUGIN_EXPORT int zenoh_subscribe(const char *key_expr, SubscriberCallback c
     printf("Setting up subscriber for: %s in slot %d\n", key_expr, slot_index);
 
     // Initialize subscriber slot
-    subscriber_t* sub = &g_subscribers[slot_index];
-    sub->id = g_next_subscriber_id++;
+    subscriber_t* sub = subscriber_at(slot_index);
+    subscriber_info_t* info = subscriber_info_at(slot_index);
     sub->callback = callback;
-    sub->active = true;
-    strncpy(sub->key_expr, key_expr, sizeof(sub->key_expr) - 1);
-
-    // Create key expression
-    z_view_keyexpr_t keyexpr;
-    if (z_view_keyexpr_from_str(&keyexpr, key_expr) < 0) {
-        printf("Invalid key expression: %s\n", key_expr);
-        sub->active = false;
-        return -4;
+    sub->bytes_callback = bytes_callback;
+    info->key_expr = strdup(key_expr);
+    if (info->key_expr == NULL) {
+        free(pull);
+        release_subscriber_slot(slot_index);
+        z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+        return -2;
     }
 
-    // Allocate memory for subscriber ID to pass to callback
-    int* subscriber_id_ptr = (int*)malloc(sizeof(int));
-    *subscriber_id_ptr = sub->id;
-
-    // Create closure for the callback
     z_owned_closure_sample_t closure;
-    z_closure_sample(&closure, data_handler, NULL, subscriber_id_ptr);
+    if (pull != NULL) {
+        // The channel closure queues samples natively, no callback into Dart
+        if (pull->mode == SUBSCRIBER_MODE_LATEST) {
+            if (!latest_map_init(&pull->latest, pull->capacity)) {
+                free(pull);
+                release_subscriber_slot(slot_index);
+                z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+                return -2;
+            }
+            z_closure_sample(&closure, latest_data_handler, latest_channel_drop, pull);
+        } else if (pull->mode == SUBSCRIBER_MODE_FIFO) {
+            z_fifo_channel_sample_new(&closure, &pull->fifo, pull->capacity);
+        } else {
+            z_ring_channel_sample_new(&closure, &pull->ring, pull->capacity);
+        }
+        info->pull = pull;
+    } else {
+        // Closure context pointing straight at the record, freed by the closure drop
+        // Port subscribers carry their ports in it, so they outlive the record
+        size_t ref_size = port_count > 0
+            ? sizeof(port_ref_t) + sizeof(Dart_Port) * (size_t)port_count
+            : sizeof(subscriber_ref_t);
+        subscriber_ref_t* ref = (subscriber_ref_t*)malloc(ref_size);
+        if (ref == NULL) {
+            release_subscriber_slot(slot_index);
+            z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+            return -2;
+        }
+        ref->sub = sub;
+        ref->id = sub->id;
+        if (port_count > 0) {
+            port_ref_t* port_ref = (port_ref_t*)ref;
+            port_ref->port_count = port_count;
+            memcpy(port_ref->ports, ports, sizeof(Dart_Port) * (size_t)port_count);
+        }
+
+        // Create closure for the callback
+        z_closure_sample(&closure, handler, free, ref);
+    }
+
+    // Publish the record before the first sample can arrive, the declaration
+    // itself goes out without the lock
+    sub->active = true;
+    info->declared = false;
+    z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
 
     // Declare subscriber
     z_subscriber_options_t sub_options;
     z_subscriber_options_default(&sub_options);
-    
-    if (z_declare_subscriber(z_loan(session), &sub->subscriber, z_loan(keyexpr), z_move(closure), &sub_options) < 0) {
+
+    z_owned_subscriber_t declared;
+    bool ok = z_declare_subscriber(z_loan(session), &declared, z_loan(keyexpr), z_move(closure), &sub_options) >= 0;
+
+    z_mutex_lock(z_loan_mut(g_subscribers.mutex));
+    if (!ok) {
         printf("Unable to declare subscriber for key: %s\n", key_expr);
-        sub->active = false;
-        free(subscriber_id_ptr);
+        // The failed declaration dropped the closure, and a LATEST channel with it
+        detach_latest_channel(slot_index);
+        release_subscriber_slot(slot_index);
+        z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
         return -5;
     }
 
-    printf("Subscriber successfully declared on '%s' with ID: %d\n", key_expr, sub->id);
-    return sub->id; // Return subscriber ID
+    z_take(&info->subscriber, z_move(declared));
+    info->declared = true;
+    if (!sub->active) {
+        // zenoh_unsubscribe_all() ran meanwhile and left the record to us
+        drop_subscriber_slot(slot_index);
+        z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+        return -1;
+    }
+
+    int subscriber_id = sub->id;
+    z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+
+    printf("Subscriber successfully declared on '%s' with ID: %d\n", key_expr, subscriber_id);
+    return subscriber_id; // Return subscriber ID
+}
+
+// FIXED MULTIPLE SUBSCRIBER IMPLEMENTATION
+FFI_PLUGIN_EXPORT int zenoh_subscribe(const char *key_expr, SubscriberCallback callback)
+{
+    if (!session_opened) {
+        printf("Session not opened\n");
+        return -1;
+    }
+
+    if (key_expr == NULL || callback == NULL) {
+        printf("Invalid arguments\n");
+        return -3;
+    }
+
+    return declare_subscriber_slot(key_expr, callback, NULL, data_handler, NULL, NULL, 0);
+}
+
+// Binary subscriber - payload is delivered as a pointer+length view, no copies
+FFI_PLUGIN_EXPORT int zenoh_subscribe_bytes(const char *key_expr, SubscriberBytesCallback callback)
+{
+    if (!session_opened) {
+        printf("Session not opened\n");
+        return -1;
+    }
+
+    if (key_expr == NULL || callback == NULL) {
+        printf("Invalid arguments\n");
+        return -3;
+    }
+
+    return declare_subscriber_slot(key_expr, NULL, callback, bytes_data_handler, NULL, NULL, 0);
+}
+
+// Declare a subscriber whose samples queue in a native channel of the given mode
+static int subscribe_pull(const char *key_expr, int mode, size_t capacity)
+{
+    if (!session_opened) {
+        printf("Session not opened\n");
+        return -1;
+    }
+
+    if (key_expr == NULL || capacity == 0) {
+        printf("Invalid arguments\n");
+        return -3;
+    }
+
+    pull_channel_t *pull = (pull_channel_t *)calloc(1, sizeof(pull_channel_t));
+    if (pull == NULL) {
+        return -2;
+    }
+    pull->mode = mode;
+    pull->capacity = capacity;
+
+    return declare_subscriber_slot(key_expr, NULL, NULL, NULL, pull, NULL, 0);
+}
+
+// Ring subscriber - keeps the latest capacity samples natively, dropping the
+// oldest under bursts, until Dart drains them with zenoh_subscriber_drain()
+FFI_PLUGIN_EXPORT int zenoh_subscribe_ring(const char *key_expr, size_t capacity)
+{
+    return subscribe_pull(key_expr, SUBSCRIBER_MODE_RING, capacity);
+}
+
+// FIFO subscriber - queues every sample natively until Dart drains them with
+// zenoh_subscriber_drain(), applying backpressure once capacity samples are pending
+FFI_PLUGIN_EXPORT int zenoh_subscribe_fifo(const char *key_expr, size_t capacity)
+{
+    return subscribe_pull(key_expr, SUBSCRIBER_MODE_FIFO, capacity);
+}
+
+// Coalescing subscriber - keeps only the newest sample of each key matching
+// key_expr, sized for capacity distinct keys, so a drain returns at most one
+// record per key updated since the previous drain
+FFI_PLUGIN_EXPORT int zenoh_subscribe_latest(const char *key_expr, size_t capacity)
+{
+    return subscribe_pull(key_expr, SUBSCRIBER_MODE_LATEST, capacity);
+}
+
+// Serialize one sample as a sample_record_t, returns the record size or 0 if it does not fit
+static size_t write_sample_record(const z_loaned_sample_t *sample, uint8_t *out, size_t space)
+{
+    z_view_string_t key_string;
+    z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_string);
+    const z_loaned_bytes_t *payload = z_sample_payload(sample);
+    const z_loaned_bytes_t *attachment = z_sample_attachment(sample);
+
+    sample_record_t record;
+    record.key_len = (uint32_t)z_string_len(z_loan(key_string));
+    record.payload_len = (uint32_t)z_bytes_len(payload);
+    record.kind = (uint32_t)z_sample_kind(sample);
+    const z_timestamp_t *timestamp = z_sample_timestamp(sample);
+    record.timestamp = timestamp ? z_timestamp_ntp64_time(timestamp) : 0;
+    record.attachment_len = attachment != NULL ? (uint32_t)z_bytes_len(attachment) : 0;
+
+    size_t size = (sizeof(sample_record_t) + record.key_len + record.payload_len + record.attachment_len + 7) &
+                  ~(size_t)7;
+    if (size > space) {
+        return 0;
+    }
+    record.size = (uint32_t)size;
+
+    memcpy(out, &record, sizeof(sample_record_t));
+    out += sizeof(sample_record_t);
+    memcpy(out, z_string_data(z_loan(key_string)), record.key_len);
+    out += record.key_len;
+    z_bytes_reader_t reader = z_bytes_get_reader(payload);
+    z_bytes_reader_read(&reader, out, record.payload_len);
+    if (record.attachment_len > 0) {
+        z_bytes_reader_t attachment_reader = z_bytes_get_reader(attachment);
+        z_bytes_reader_read(&attachment_reader, out + record.payload_len, record.attachment_len);
+    }
+    return size;
+}
+
+// Receive the next queued sample of a pull subscriber without blocking
+static bool pull_channel_next(pull_channel_t *pull, z_owned_sample_t *sample)
+{
+    if (pull->has_pending) {
+        z_take(sample, z_move(pull->pending));
+        pull->has_pending = false;
+        return true;
+    }
+    if (pull->mode == SUBSCRIBER_MODE_FIFO) {
+        return z_fifo_handler_sample_try_recv(z_loan(pull->fifo), sample) == Z_OK;
+    }
+    return z_ring_handler_sample_try_recv(z_loan(pull->ring), sample) == Z_OK;
+}
+
+// Copy the keys updated since the last drain into out_buf, resuming from the
+// bucket the previous drain stopped at so frequently updated keys cannot starve the rest
+static int latest_map_drain(latest_map_t *map, uint8_t *out_buf, size_t buf_size, int max_samples)
+{
+    z_mutex_lock(z_loan_mut(map->mutex));
+
+    int count = 0;
+    size_t offset = 0;
+    size_t mask = map->bucket_count - 1;
+    size_t index = map->cursor;
+    size_t scanned = 0;
+    while (count < max_samples && map->dirty_count > 0 && scanned < map->bucket_count) {
+        latest_entry_t *entry = &map->entries[index];
+        if (entry->dirty) {
+            size_t size = write_sample_record(z_loan(entry->sample), out_buf + offset, buf_size - offset);
+            if (size == 0) {
+                break;
+            }
+            entry->dirty = false;
+            map->dirty_count--;
+            offset += size;
+            count++;
+        }
+        index = (index + 1) & mask;
+        scanned++;
+    }
+    map->cursor = index;
+
+    bool too_small = count == 0 && map->dirty_count > 0;
+    z_mutex_unlock(z_loan_mut(map->mutex));
+    return too_small ? -7 : count;
+}
+
+// Copy up to max_samples queued samples into out_buf as sample_record_t entries
+// Returns the number of records written, or -7 if the next sample needs a bigger buffer
+FFI_PLUGIN_EXPORT int zenoh_subscriber_drain(int subscriber_id, uint8_t *out_buf, size_t buf_size, int max_samples)
+{
+    if (out_buf == NULL) {
+        return -3;
+    }
+
+    // Held for the whole drain so the channel cannot be freed underneath us
+    z_mutex_lock(z_loan_mut(g_subscribers.mutex));
+
+    int slot_index = find_subscriber_slot_by_id(subscriber_id);
+    pull_channel_t *pull = slot_index >= 0 ? subscriber_info_at(slot_index)->pull : NULL;
+    if (pull == NULL) {
+        z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+        return -1;
+    }
+
+    if (pull->mode == SUBSCRIBER_MODE_LATEST) {
+        int result = latest_map_drain(&pull->latest, out_buf, buf_size, max_samples);
+        z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+        return result;
+    }
+
+    int count = 0;
+    size_t offset = 0;
+    z_owned_sample_t sample;
+    while (count < max_samples && pull_channel_next(pull, &sample)) {
+        size_t size = write_sample_record(z_loan(sample), out_buf + offset, buf_size - offset);
+        if (size == 0) {
+            // Keep it for the next drain
+            z_take(&pull->pending, z_move(sample));
+            pull->has_pending = true;
+            break;
+        }
+        z_drop(z_move(sample));
+        offset += size;
+        count++;
+    }
+
+    bool too_small = count == 0 && pull->has_pending;
+    z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
+    return too_small ? -7 : count;
+}
+
+// Finalizer of a posted sample, runs once the receiving isolate drops it
+static void port_sample_finalizer(void *isolate_callback_data, void *peer)
+{
+    (void)isolate_callback_data;
+    slab_release(peer);
+}
+
+// Port subscriber handler - posts each sample as one sample record in an
+// external Uint8List, the buffer is owned by Dart from then on
+void port_data_handler(z_loaned_sample_t *sample, void *arg)
+{
+    const port_ref_t *port_ref = (const port_ref_t *)arg;
+    if (subscriber_from_ref(&port_ref->ref) == NULL || g_post_cobject == NULL) {
+        return;
+    }
+
+    z_view_string_t key_string;
+    z_keyexpr_as_view_string(z_sample_keyexpr(sample), &key_string);
+    const char *key = z_string_data(z_loan(key_string));
+    size_t key_len = z_string_len(z_loan(key_string));
+    const z_loaned_bytes_t *attachment = z_sample_attachment(sample);
+    size_t attachment_len = attachment != NULL ? z_bytes_len(attachment) : 0;
+    size_t size = (sizeof(sample_record_t) + key_len + z_bytes_len(z_sample_payload(sample)) + attachment_len + 7) &
+                  ~(size_t)7;
+
+    // zenoh calls a subscriber's closure serially, so one port per key keeps its order
+    Dart_Port port = port_ref->ports[0];
+    if (port_ref->port_count > 1) {
+        port = port_ref->ports[key_hash(key, key_len) % (uint64_t)port_ref->port_count];
+    }
+
+    uint8_t *buf = (uint8_t *)slab_alloc(size);
+    if (buf == NULL) {
+        printf("Failed to allocate port sample buffer\n");
+        return;
+    }
+    write_sample_record(sample, buf, size);
+
+    Dart_CObject message;
+    message.type = Dart_CObject_kExternalTypedData;
+    message.value.as_external_typed_data.type = Dart_TypedData_kUint8;
+    message.value.as_external_typed_data.length = (intptr_t)size;
+    message.value.as_external_typed_data.data = buf;
+    message.value.as_external_typed_data.peer = buf;
+    message.value.as_external_typed_data.callback = port_sample_finalizer;
+
+    // A closed port never runs the finalizer, so the buffer is still ours
+    if (!g_post_cobject(port, &message)) {
+        slab_release(buf);
+    }
+}
+
+// Hand over NativeApi.postCObject, required before zenoh_subscribe_port()
+FFI_PLUGIN_EXPORT void zenoh_init_dart_api(void *post_cobject)
+{
+    g_post_cobject = (Dart_PostCObject_Type)post_cobject;
+}
+
+// Port subscriber - each sample is posted to the native port of a SendPort,
+// which may belong to any isolate, as a Uint8List holding one sample record
+FFI_PLUGIN_EXPORT int zenoh_subscribe_port(const char *key_expr, int64_t port)
+{
+    return zenoh_subscribe_ports(key_expr, &port, 1);
+}
+
+// Sharded port subscriber - samples are spread across port_count ports by key
+// hash, e.g. one per worker isolate, and each key always lands on the same port
+FFI_PLUGIN_EXPORT int zenoh_subscribe_ports(const char *key_expr, const int64_t *ports, int port_count)
+{
+    if (!session_opened) {
+        printf("Session not opened\n");
+        return -1;
+    }
+
+    if (key_expr == NULL || ports == NULL || port_count < 1 || port_count > MAX_PORT_SHARDS ||
+        g_post_cobject == NULL) {
+        printf("Invalid arguments\n");
+        return -3;
+    }
+
+    for (int i = 0; i < port_count; i++) {
+        if (ports[i] == 0) {
+            return -3;
+        }
+    }
+
+    return declare_subscriber_slot(key_expr, NULL, NULL, port_data_handler, NULL, ports, port_count);
+}
+
+// Take an extra reference on a sample or reply handle, e.g. for a payload
+// view whose finalizer releases it independently of the handle owner
+FFI_PLUGIN_EXPORT void zenoh_sample_retain(void *sample_handle)
+{
+    sample_handle_t *handle = (sample_handle_t *)sample_handle;
+    if (handle != NULL) {
+        ATOMIC_INCREMENT(&handle->refs);
+    }
+}
+
+// Drop a reference on a sample or reply handle handed to Dart, the sample
+// is released with the last one
+FFI_PLUGIN_EXPORT void zenoh_sample_release(void *sample_handle)
+{
+    sample_handle_t *handle = (sample_handle_t *)sample_handle;
+    if (handle == NULL || ATOMIC_DECREMENT(&handle->refs) > 0) {
+        return;
+    }
+    sample_handle_drop_slices(handle);
+    z_drop(z_move(handle->sample));
+    free(handle);
 }
 
 // Unsubscribe specific subscriber
 FFI_PLUGIN_EXPORT void zenoh_unsubscribe(int subscriber_id)
 {
-    subscriber_t* sub = find_subscriber_by_id(subscriber_id);
-    if (sub != NULL && sub->active) {
-        z_drop(z_move(sub->subscriber));
-        sub->active = false;
-        sub->callback = NULL;
-        printf("Subscriber %d closed for key: %s\n", subscriber_id, sub->key_expr);
+    z_mutex_lock(z_loan_mut(g_subscribers.mutex));
+    int slot_index = find_subscriber_slot_by_id(subscriber_id);
+    if (slot_index >= 0) {
+        printf("Subscriber %d closed for key: %s\n", subscriber_id, subscriber_info_at(slot_index)->key_expr);
+        drop_subscriber_slot(slot_index);
     } else {
         printf("Subscriber %d not found or already inactive\n", subscriber_id);
     }
+    z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
 }
 
 // Unsubscribe all subscribers
 FFI_PLUGIN_EXPORT void zenoh_unsubscribe_all(void)
 {
-    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
-        if (g_subscribers[i].active) {
-            z_drop(z_move(g_subscribers[i].subscriber));
-            g_subscribers[i].active = false;
-            g_subscribers[i].callback = NULL;
+    z_mutex_lock(z_loan_mut(g_subscribers.mutex));
+    int total = g_subscribers.chunk_count * SUBSCRIBER_CHUNK_SIZE;
+    for (int i = 0; i < total; i++) {
+        subscriber_t* sub = subscriber_at(i);
+        if (sub->active && !subscriber_info_at(i)->declared) {
+            // Still being declared, the declaring thread drops it
+            sub->active = false;
+        } else if (sub->active) {
+            drop_subscriber_slot(i);
         }
     }
+    z_mutex_unlock(z_loan_mut(g_subscribers.mutex));
     printf("All subscribers closed\n");
 }
 
-// Initialize subscribers array
+// Initialize subscribers table
 __attribute__((constructor))
 static void initialize_subscribers(void) {
-    for (int i = 0; i < MAX_SUBSCRIBERS; i++) {
-        g_subscribers[i].active = false;
-        g_subscribers[i].callback = NULL;
-        g_subscribers[i].id = -1;
-        g_subscribers[i].key_expr[0] = '\0';
+    g_subscribers.chunks = NULL;
+    g_subscribers.chunk_count = 0;
+    g_subscribers.chunk_capacity = 0;
+    g_subscribers.free_head = -1;
+    z_mutex_init(&g_subscribers.mutex);
+}
+
+// Initialize the publish buffer pool
+__attribute__((constructor))
+static void initialize_publish_pool(void) {
+    for (int i = 0; i < PUBLISH_POOL_CLASSES; i++) {
+        g_publish_pool.free_lists[i] = NULL;
+        g_publish_pool.free_counts[i] = 0;
+    }
+    z_mutex_init(&g_publish_pool.mutex);
+}
+
+// Carve the callback buffer slabs, pages are only touched once used
+__attribute__((constructor))
+static void initialize_slabs(void) {
+    static const size_t block_sizes[SLAB_CLASSES] = {64, 256, 1024, 4096};
+    static const uint32_t block_counts[SLAB_CLASSES] = {8192, 4096, 1024, 256};
+
+    for (int i = 0; i < SLAB_CLASSES; i++) {
+        slab_class_t *slab = &g_slabs[i];
+        slab->block_size = block_sizes[i];
+        slab->block_count = block_counts[i];
+        slab->base = (uint8_t *)malloc(block_sizes[i] * block_counts[i]);
+        slab->next = (uint32_t *)malloc(sizeof(uint32_t) * block_counts[i]);
+        if (slab->base == NULL || slab->next == NULL) {
+            // Leave the class unused, slab_alloc() falls back to malloc
+            free(slab->base);
+            free(slab->next);
+            slab->base = NULL;
+            slab->next = NULL;
+            continue;
+        }
+        for (uint32_t j = 0; j < block_counts[i]; j++) {
+            slab->next[j] = j + 1 < block_counts[i] ? j + 1 : SLAB_EMPTY;
+        }
+        slab->head = 0;
+    }
+}
+
+// Initialize the zenoh_publish() publisher cache
+__attribute__((constructor))
+static void initialize_publish_cache(void) {
+    memset(&g_publish_cache, 0, sizeof(g_publish_cache));
+    for (int i = 0; i < PUBLISH_CACHE_BUCKETS; i++) {
+        g_publish_cache.buckets[i] = -1;
+    }
+    z_mutex_init(&g_publish_cache.mutex);
+}
+
+// Initialize the key expression cache
+__attribute__((constructor))
+static void initialize_keyexpr_cache(void) {
+    memset(&g_keyexpr_cache, 0, sizeof(g_keyexpr_cache));
+    for (int i = 0; i < KEYEXPR_CACHE_BUCKETS; i++) {
+        g_keyexpr_cache.buckets[i] = -1;
     }
-}
\ No newline at end of file
+    z_mutex_init(&g_keyexpr_cache.mutex);
+}
+
+// Initialize the sample key intern table, buckets are allocated on first use
+__attribute__((constructor))
+static void initialize_key_table(void) {
+    g_key_table.buckets = NULL;
+    g_key_table.bucket_count = 0;
+    g_key_table.count = 0;
+    z_mutex_init(&g_key_table.mutex);
+}
+
+// Initialize the publisher registry lock
+__attribute__((constructor))
+static void initialize_publishers(void) {
+    z_mutex_init(&g_publishers_mutex);
+}
+
+// Initialize the queryable registry lock
+__attribute__((constructor))
+static void initialize_queryables(void) {
+    z_mutex_init(&g_queryables_mutex);
+}
+
+// Initialize the querier registry lock
+__attribute__((constructor))
+static void initialize_queriers(void) {
+    z_mutex_init(&g_queriers_mutex);
+}
+
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+// Initialize the SHM provider lock, the provider itself is created on first use
+__attribute__((constructor))
+static void initialize_shm_provider(void) {
+    z_mutex_init(&shm_provider_mutex);
+}
+#endif
@@ -6,6 +6,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <limits.h>
 // #include <zenoh.h>
 
 #if __has_include(<zenoh.h>)
@@ -16,6 +17,8 @@
     #error "zenoh.h not found!"
 #endif
 
+#include "dart_cobject.h"
+
 #if _WIN32
 #include <windows.h>
 #else
@@ -32,6 +35,33 @@
 #define FFI_PLUGIN_EXPORT
 #endif
 
+// Atomic reference counting on an int, both return the new value
+#if defined(_MSC_VER)
+#define ATOMIC_INCREMENT(p) InterlockedIncrement((volatile LONG*)(p))
+#define ATOMIC_DECREMENT(p) InterlockedDecrement((volatile LONG*)(p))
+#else
+#define ATOMIC_INCREMENT(p) __atomic_add_fetch((p), 1, __ATOMIC_RELAXED)
+#define ATOMIC_DECREMENT(p) __atomic_sub_fetch((p), 1, __ATOMIC_ACQ_REL)
+#endif
+
+// Lock-free list heads, ATOMIC_CAS64 refreshes *expected when it fails
+#if defined(_MSC_VER)
+#define ATOMIC_LOAD(p) (*(p))  // Aligned loads are atomic on MSVC targets
+static inline bool atomic_cas64(volatile uint64_t* p, uint64_t* expected, uint64_t desired) {
+    uint64_t seen = (uint64_t)InterlockedCompareExchange64((volatile LONG64*)p, (LONG64)desired, (LONG64)*expected);
+    if (seen == *expected) {
+        return true;
+    }
+    *expected = seen;
+    return false;
+}
+#define ATOMIC_CAS64(p, expected, desired) atomic_cas64((p), (expected), (desired))
+#else
+#define ATOMIC_LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define ATOMIC_CAS64(p, expected, desired) \
+    __atomic_compare_exchange_n((p), (expected), (desired), true, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#endif
+
 // LOG MACRO for debugging
 //#define LOG_DEBUG(fmt, ...) printf("ZENOH_DART DEBUG: " fmt "\n", ##__VA_ARGS__)
 //#else
@@ -40,51 +70,475 @@
 
 
 // Callback function pointer type for Flutter
-typedef void (*SubscriberCallback)(const char* key, const char* value, const char* kind, const char* attachment, int subscriber_id);
+// key_id >= 0: key is interned and stays valid while the library is loaded
+// key_id < 0: the intern table is full and key lives in the value block
+// kind is a z_sample_kind_t, Dart returns the block with zenoh_release(value)
+// attachment is NULL when the sample carries none, otherwise attachment_len
+// bytes copied into the value block
+typedef void (*SubscriberCallback)(const char* key, int key_id, const char* value, int kind, const uint8_t* attachment, size_t attachment_len, int subscriber_id);
 
-// TODO: unidentified issue with multiple subscribers, need to investigate
-// Define maximum number of subscribers
-// Maximum dictionary of concurrent subscribers
-#define MAX_SUBSCRIBERS 255
+// Binary callback function pointer type for Flutter
+// key/payload/attachment point into the sample held by sample_handle, valid until zenoh_sample_release()
+// attachment is NULL when the sample carries none
+// is_shm is set when payload is a shared memory mapping rather than a zenoh buffer
+typedef void (*SubscriberBytesCallback)(const char* key, size_t key_len, const uint8_t* payload, size_t payload_len, const uint8_t* attachment, size_t attachment_len, int kind, int is_shm, void* sample_handle, int subscriber_id);
 
+// Queryable callback function pointer type for Flutter
+// key/parameters/payload/attachment point into the query held by query_handle, valid until zenoh_query_release()
+typedef void (*QueryCallback)(int queryable_handle, const char* key, size_t key_len, const char* parameters, size_t parameters_len, const uint8_t* payload, size_t payload_len, const uint8_t* attachment, size_t attachment_len, void* query_handle);
 
-// Subscriber structure
+// Reply status passed to GetReplyCallback
+#define ZENOH_REPLY_OK 0
+#define ZENOH_REPLY_ERROR 1
+#define ZENOH_REPLY_DONE 2
+
+// Async get callback - called once per reply, then once with ZENOH_REPLY_DONE
+// key/payload/attachment point into reply_handle, valid until zenoh_sample_release()
+typedef void (*GetReplyCallback)(int request_id, int status, const char* key, size_t key_len, const uint8_t* payload, size_t payload_len, const uint8_t* attachment, size_t attachment_len, void* reply_handle);
+
+// Reply record in a zenoh_get_all() result buffer, followed by the key,
+// payload and encoding bytes, the next record starts at the next 8 byte boundary
+typedef struct {
+    uint32_t key_len;
+    uint32_t payload_len;
+    uint32_t encoding_len;
+    uint32_t is_error;
+    uint64_t timestamp;  // NTP64 time, 0 when the sample carries none
+} reply_record_t;
+
+// Subscriber delivery modes
+#define SUBSCRIBER_MODE_CALLBACK 0
+#define SUBSCRIBER_MODE_RING 1
+#define SUBSCRIBER_MODE_FIFO 2
+#define SUBSCRIBER_MODE_LATEST 3
+
+// Sample record written by zenoh_subscriber_drain(), followed by the key,
+// payload and attachment bytes, the next record starts size bytes after this one
+typedef struct {
+    uint32_t size;  // Record size including padding to 8 bytes
+    uint32_t key_len;
+    uint32_t payload_len;
+    uint32_t kind;
+    uint64_t timestamp;  // NTP64 time, 0 when the sample carries none
+    uint32_t attachment_len;  // Attachment bytes follow the payload
+} sample_record_t;
+
+// Subscriber ids encode the table index in the low bits and a reuse
+// generation above it, so a stale id never matches a recycled record
+#define SUBSCRIBER_INDEX_BITS 20
+#define SUBSCRIBER_INDEX_MASK ((1 << SUBSCRIBER_INDEX_BITS) - 1)
+#define MAX_SUBSCRIBERS (1 << SUBSCRIBER_INDEX_BITS)
+
+// Records are allocated in chunks of this size and never move
+#define SUBSCRIBER_CHUNK_SIZE 64
+
+// Subscriber structure - hot fields only, read on every sample
 typedef struct {
-    z_owned_subscriber_t subscriber;
     SubscriberCallback callback;
+    SubscriberBytesCallback bytes_callback;
+    int id;
     bool active;
+} subscriber_t;
+
+// Latest sample of one key of a coalescing subscriber
+typedef struct {
+    char* key;  // NULL for an empty bucket
+    size_t key_len;
+    uint64_t hash;
+    z_owned_sample_t sample;
+    bool dirty;  // Updated since it was last drained
+} latest_entry_t;
+
+// Open-addressing map from key to its latest sample, written by the zenoh
+// callback thread and read by zenoh_subscriber_drain()
+typedef struct {
+    latest_entry_t* entries;
+    size_t bucket_count;  // Power of two
+    size_t count;
+    size_t dirty_count;
+    size_t cursor;  // Bucket the next drain resumes from
+    z_owned_mutex_t mutex;
+} latest_map_t;
+
+// Native sample channel of a pull-mode subscriber, drained by Dart in bulk
+typedef struct {
+    int mode;
+    size_t capacity;
+    z_owned_ring_handler_sample_t ring;  // SUBSCRIBER_MODE_RING
+    z_owned_fifo_handler_sample_t fifo;  // SUBSCRIBER_MODE_FIFO
+    latest_map_t latest;  // SUBSCRIBER_MODE_LATEST, owned by the subscriber closure
+    z_owned_sample_t pending;  // Did not fit the last drain buffer
+    bool has_pending;
+} pull_channel_t;
+
+// Cold subscriber fields, only touched on subscribe/unsubscribe
+typedef struct {
+    z_owned_subscriber_t subscriber;
+    pull_channel_t* pull;  // NULL for callback subscribers
+    char* key_expr;
+    int next_free;  // Next free index while the record is unused, -1 ends the list
+    bool declared;  // subscriber is set, false while z_declare_subscriber() runs unlocked
+} subscriber_info_t;
+
+// One slab of subscriber records
+typedef struct {
+    subscriber_t hot[SUBSCRIBER_CHUNK_SIZE];
+    subscriber_info_t cold[SUBSCRIBER_CHUNK_SIZE];
+} subscriber_chunk_t;
+
+// Growable subscriber table with an intrusive free list
+typedef struct {
+    subscriber_chunk_t** chunks;
+    int chunk_count;
+    int chunk_capacity;
+    int free_head;  // -1 when every allocated record is in use
+    z_owned_mutex_t mutex;  // Guards table layout, not sample dispatch
+} subscriber_table_t;
+
+// Closure context - direct reference to the subscriber record, checked against its id
+typedef struct {
+    subscriber_t* sub;
     int id;
+} subscriber_ref_t;
+
+// Most ports a port subscriber can shard its samples across
+#define MAX_PORT_SHARDS 64
+
+// Closure context of a port subscriber, samples are sharded across ports by
+// key hash so every key keeps its order on one port
+typedef struct {
+    subscriber_ref_t ref;
+    int port_count;
+    Dart_Port ports[];
+} port_ref_t;
+
+// Maximum number of concurrently declared publishers
+#define MAX_PUBLISHERS 64
+
+// Option fields set to this keep the zenoh default
+#define ZENOH_OPTION_DEFAULT -1
+
+// Publisher declaration and put options, NULL means zenoh defaults
+typedef struct {
+    const char* encoding;
+    int priority;  // z_priority_t
+    int congestion_control;  // z_congestion_control_t
+    int is_express;  // 1 sends without batching
+    int reliability;  // z_reliability_t, ignored without Z_FEATURE_UNSTABLE_API
+} publisher_options_t;
+
+// Publisher structure
+typedef struct {
+    z_owned_publisher_t publisher;
+    bool active;
     char key_expr[256];
-} subscriber_t;
+} publisher_t;
+
+// Publishers kept warm for zenoh_publish(), apart from the handle registry
+#define PUBLISH_CACHE_SIZE 32
+#define PUBLISH_CACHE_BUCKETS 64  // Power of two
+
+// A publisher declared by zenoh_publish() for one key
+typedef struct {
+    z_owned_publisher_t publisher;
+    char* key;
+    uint64_t hash;
+    uint64_t last_used;  // Cache clock at the last publish, for LRU eviction
+    int users;           // Publishes in flight, pins the entry
+    int next;            // Next entry in the same bucket, -1 ends the chain
+    bool active;
+} publish_cache_entry_t;
+
+// LRU of zenoh_publish() publishers, looked up by key hash
+typedef struct {
+    publish_cache_entry_t entries[PUBLISH_CACHE_SIZE];
+    int buckets[PUBLISH_CACHE_BUCKETS];  // First entry of each chain, -1 when empty
+    uint64_t clock;
+    z_owned_mutex_t mutex;
+} publish_cache_t;
+
+#define MAX_QUERIERS 64
+
+// Querier structure - routing to the queryables of key_expr is resolved once
+typedef struct {
+    z_owned_querier_t querier;
+    bool active;
+    char key_expr[256];
+} querier_t;
+
+// Per-request context of an async get, owned by the reply closure
+typedef struct {
+    GetReplyCallback callback;
+    int request_id;
+} get_context_t;
+
+// Per-call state of a blocking zenoh_get, passed as the reply closure context
+typedef struct {
+    z_owned_mutex_t mutex;
+    z_owned_condvar_t condvar;
+    char* value;  // First successful reply, handed over to the caller
+    bool taken;   // Caller stopped waiting, later replies are ignored
+    bool done;    // Query finished, no more replies will arrive
+    int refs;     // Caller + closure, guarded by mutex
+} get_sync_context_t;
+
+// Sample handle handed to Dart by the binary subscriber path
+typedef struct {
+    z_owned_sample_t sample;
+    z_owned_slice_t slice;  // Only used when the payload is fragmented
+    z_owned_slice_t attachment_slice;  // Only used when the attachment is fragmented
+    bool owns_slice;
+    bool owns_attachment_slice;
+    bool is_shm;  // Payload view points into a shared memory mapping
+    int refs;  // Dropped by zenoh_sample_release(), starts at 1
+} sample_handle_t;
+
+// Query handle handed to Dart, replied to with zenoh_query_reply()
+typedef struct {
+    z_owned_query_t query;
+    z_owned_slice_t slice;  // Only used when the payload is fragmented
+    z_owned_slice_t attachment_slice;  // Only used when the attachment is fragmented
+    bool owns_slice;
+    bool owns_attachment_slice;
+    const uint8_t* payload;
+    size_t payload_len;
+    const uint8_t* attachment;  // NULL when the query carries none
+    size_t attachment_len;
+} query_handle_t;
+
+#define MAX_QUERYABLES 64
+
+// Queryable delivery modes
+#define QUERYABLE_MODE_CALLBACK 0
+#define QUERYABLE_MODE_RING 1  // Ring queue, a full queue drops its oldest query
+
+// Query record written by zenoh_queryable_drain(), followed by the key,
+// parameters, payload and attachment bytes, the next record starts size bytes
+// after this one
+typedef struct {
+    uint32_t size;  // Record size including padding to 8 bytes
+    uint32_t key_len;
+    uint32_t parameters_len;
+    uint32_t payload_len;
+    uint64_t query_handle;  // query_handle_t*, owned by Dart once drained
+    uint32_t attachment_len;
+} query_record_t;
+
+// Closure context of a callback-mode queryable, freed by the closure drop
+typedef struct {
+    QueryCallback callback;
+    int handle;
+} queryable_context_t;
+
+// Queryable structure
+typedef struct {
+    z_owned_queryable_t queryable;
+    int mode;
+    z_owned_ring_handler_query_t ring;  // QUERYABLE_MODE_RING
+    query_handle_t* pending;  // Did not fit the last drain buffer
+    bool active;
+    char key_expr[256];
+} queryable_t;
+
+// Most keys interned for the sample callback, later keys are copied per sample
+#define KEY_TABLE_MAX 65536
+
+// Interned key, the string is never freed so Dart can cache it by id
+typedef struct {
+    char* key;  // NULL for an empty bucket
+    size_t key_len;
+    uint64_t hash;
+    int id;
+} key_bucket_t;
+
+// Open-addressing table of interned sample keys, shared by every subscriber
+typedef struct {
+    key_bucket_t* buckets;
+    size_t bucket_count;  // Power of two
+    int count;
+    z_owned_mutex_t mutex;
+} key_table_t;
+
+// Declared key expressions kept for session puts and gets
+#define KEYEXPR_CACHE_SIZE 64
+#define KEYEXPR_CACHE_BUCKETS 128  // Power of two
+#define KEYEXPR_ADMIT_SLOTS 256    // Power of two
+#define KEYEXPR_ADMIT_HITS 3       // Uses of a key before it is declared
+
+// A key expression declared with z_declare_keyexpr(), sent as a numeric id
+typedef struct {
+    z_owned_keyexpr_t keyexpr;
+    char* key;
+    uint64_t hash;
+    uint64_t last_used;  // Cache clock at the last hit, for LRU eviction
+    int users;           // Puts and gets in flight, pins the entry
+    int next;            // Next entry in the same bucket, -1 ends the chain
+    bool active;
+} keyexpr_entry_t;
+
+// Uses of a key not declared yet, slots are shared by keys with the same low hash bits
+typedef struct {
+    uint64_t hash;
+    uint32_t count;
+} keyexpr_admit_t;
+
+// LRU of declared key expressions, looked up by key hash
+typedef struct {
+    keyexpr_entry_t entries[KEYEXPR_CACHE_SIZE];
+    int buckets[KEYEXPR_CACHE_BUCKETS];  // First entry of each chain, -1 when empty
+    keyexpr_admit_t admit[KEYEXPR_ADMIT_SLOTS];
+    uint64_t clock;
+    uint64_t hits;
+    uint64_t misses;
+    z_owned_mutex_t mutex;
+} keyexpr_cache_t;
+
+// Callback buffer slab, 64 B / 256 B / 1 KiB / 4 KiB blocks
+// Larger buffers are allocated and freed directly
+#define SLAB_CLASSES 4
+#define SLAB_EMPTY UINT32_MAX
+
+// One slab size class, blocks are carved from a single region and the free
+// list links them by index so the head can carry an ABA tag
+typedef struct {
+    uint8_t* base;
+    uint32_t* next;  // Next free block after each block
+    uint64_t head;   // ABA tag in the high half, first free block in the low half
+    size_t block_size;
+    uint32_t block_count;
+} slab_class_t;
+
+// Publish buffer pool size classes, powers of two from 4 KiB to 16 MiB
+// Larger buffers are allocated and freed directly
+#define PUBLISH_POOL_MIN_SHIFT 12
+#define PUBLISH_POOL_CLASSES 13
+#define PUBLISH_POOL_MAX_FREE 8  // Buffers kept per class once released
+
+// Header in front of every publish buffer, the payload follows it
+typedef struct pool_buffer_t {
+    struct pool_buffer_t* next_free;
+    size_t capacity;
+    int size_class;  // -1 for oversized buffers
+} pool_buffer_t;
+
+// Free lists of publish buffers, refilled by the zenoh deleter threads
+typedef struct {
+    pool_buffer_t* free_lists[PUBLISH_POOL_CLASSES];
+    int free_counts[PUBLISH_POOL_CLASSES];
+    z_owned_mutex_t mutex;
+} publish_pool_t;
+
+// Shared memory pool created on the first zenoh_shm_alloc()
+#define ZENOH_SHM_POOL_SIZE (64 * 1024 * 1024)
+
+// Writable buffer handed to Dart by zenoh_shm_alloc(), consumed by zenoh_publish_shm()
+typedef struct {
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+    z_owned_shm_mut_t shm;  // Only valid when is_shm
+#endif
+    uint8_t* data;
+    size_t len;
+    bool is_shm;  // false when backed by the heap because SHM is unavailable
+} shm_buffer_t;
 
 // Global zenoh session variable
 static z_owned_session_t session;
 static bool session_opened = false;
 
-// Global variables for zenoh_get reply handling
-static bool reply_received = false;
-static char *last_received_value = NULL;
+#if defined(Z_FEATURE_SHARED_MEMORY) && defined(Z_FEATURE_UNSTABLE_API)
+// Session-wide SHM provider, dropped with the session
+static z_owned_shm_provider_t shm_provider;
+static bool shm_provider_ready = false;
+// Guards the lazy creation of shm_provider, its allocations and its drop
+static z_owned_mutex_t shm_provider_mutex;
+#endif
+
+// Sample keys interned for the string callback
+static key_table_t g_key_table;
+
+// Key expressions declared for hot put and get keys
+static keyexpr_cache_t g_keyexpr_cache;
+
+// Callback buffers handed to Dart, returned with zenoh_release()
+static slab_class_t g_slabs[SLAB_CLASSES];
+
+// Buffers handed to zenoh by z_bytes_from_buf() come back here
+static publish_pool_t g_publish_pool;
+
+// Dart_PostCObject of the Dart VM, set by zenoh_init_dart_api()
+static Dart_PostCObject_Type g_post_cobject = NULL;
+
+// Declared publishers, the handle is the slot index
+static publisher_t g_publishers[MAX_PUBLISHERS];
+
+// Guards g_publishers, a slot is claimed while its key_expr is set
+static z_owned_mutex_t g_publishers_mutex;
+
+// Publishers behind zenoh_publish()
+static publish_cache_t g_publish_cache;
+
+// Declared queriers, the handle is the slot index
+static querier_t g_queriers[MAX_QUERIERS];
+
+// Guards g_queriers, a slot is claimed while its key_expr is set
+static z_owned_mutex_t g_queriers_mutex;
+
+// Declared queryables, the handle is the slot index
+static queryable_t g_queryables[MAX_QUERYABLES];
 
-// Global variables for zenoh_put publisher handling
-static z_owned_publisher_t global_publisher;
-static bool publisher_declared = false;
-static char current_publisher_key[256] = "";
+// Guards g_queryables, a slot is claimed while its key_expr is set
+static z_owned_mutex_t g_queryables_mutex;
 
 // Multiple subscribers support
-static subscriber_t g_subscribers[MAX_SUBSCRIBERS];
-static int g_next_subscriber_id = 0;
+static subscriber_table_t g_subscribers;
 
 // Function declarations
 FFI_PLUGIN_EXPORT int zenoh_init(void);
 FFI_PLUGIN_EXPORT void zenoh_cleanup(void);
 FFI_PLUGIN_EXPORT int zenoh_open_session(const char* mode, const char* endpoint);
 FFI_PLUGIN_EXPORT void zenoh_close_session(void);
+FFI_PLUGIN_EXPORT void zenoh_keyexpr_cache_stats(uint64_t* hits, uint64_t* misses);
 FFI_PLUGIN_EXPORT int zenoh_put(const char* key, const char* value);
+FFI_PLUGIN_EXPORT int zenoh_put_with_options(const char* key, const char* value, const publisher_options_t* options);
+FFI_PLUGIN_EXPORT int zenoh_put_bytes(const char* key, const uint8_t* data, size_t len, const uint8_t* attachment, size_t attachment_len, const publisher_options_t* options);
 FFI_PLUGIN_EXPORT int zenoh_publish(const char* key, const char* value);
+FFI_PLUGIN_EXPORT int zenoh_declare_publisher(const char* key_expr, const publisher_options_t* options);
+FFI_PLUGIN_EXPORT int zenoh_publisher_put(int handle, const uint8_t* data, size_t len, const uint8_t* attachment, size_t attachment_len);
+FFI_PLUGIN_EXPORT int zenoh_publish_batch(int handle, const uint8_t* buf, const uint32_t* offsets, size_t count);
+FFI_PLUGIN_EXPORT void zenoh_undeclare_publisher(int handle);
+FFI_PLUGIN_EXPORT uint8_t* zenoh_buffer_alloc(size_t size);
+FFI_PLUGIN_EXPORT int zenoh_publish_buffer(int handle, uint8_t* data, size_t len);
+FFI_PLUGIN_EXPORT void zenoh_buffer_free(uint8_t* data);
+FFI_PLUGIN_EXPORT int zenoh_shm_available(void);
+FFI_PLUGIN_EXPORT void* zenoh_shm_alloc(size_t size, uint8_t** out_data);
+FFI_PLUGIN_EXPORT int zenoh_publish_shm(int handle, void* shm_buffer);
+FFI_PLUGIN_EXPORT void zenoh_shm_free(void* shm_buffer);
 FFI_PLUGIN_EXPORT char* zenoh_get(const char* key);
+FFI_PLUGIN_EXPORT int zenoh_get_async(const char* key, const char* parameters, uint64_t timeout_ms, const uint8_t* attachment, size_t attachment_len, GetReplyCallback callback, int request_id);
 FFI_PLUGIN_EXPORT char* zenoh_get_with_handler(const char* key);
+FFI_PLUGIN_EXPORT int zenoh_declare_querier(const char* key_expr, int target, int consolidation, uint64_t timeout_ms);
+FFI_PLUGIN_EXPORT int zenoh_querier_get(int handle, const char* parameters, const uint8_t* payload, size_t payload_len, const uint8_t* attachment, size_t attachment_len, GetReplyCallback callback, int request_id);
+FFI_PLUGIN_EXPORT void zenoh_undeclare_querier(int handle);
+FFI_PLUGIN_EXPORT int zenoh_get_all(const char* key, const char* parameters, uint64_t timeout_ms, uint8_t** out_buf, size_t* out_size);
 FFI_PLUGIN_EXPORT void zenoh_free_string(char* str);
+FFI_PLUGIN_EXPORT void zenoh_release(void* buffer);
+FFI_PLUGIN_EXPORT void zenoh_free_buffer(uint8_t* buf);
 FFI_PLUGIN_EXPORT int zenoh_subscribe(const char* key_expr, SubscriberCallback callback);
+FFI_PLUGIN_EXPORT int zenoh_subscribe_bytes(const char* key_expr, SubscriberBytesCallback callback);
+FFI_PLUGIN_EXPORT void zenoh_sample_retain(void* sample_handle);
+FFI_PLUGIN_EXPORT void zenoh_sample_release(void* sample_handle);
+FFI_PLUGIN_EXPORT void zenoh_init_dart_api(void* post_cobject);
+FFI_PLUGIN_EXPORT int zenoh_subscribe_port(const char* key_expr, int64_t port);
+FFI_PLUGIN_EXPORT int zenoh_subscribe_ports(const char* key_expr, const int64_t* ports, int port_count);
+FFI_PLUGIN_EXPORT int zenoh_subscribe_ring(const char* key_expr, size_t capacity);
+FFI_PLUGIN_EXPORT int zenoh_subscribe_fifo(const char* key_expr, size_t capacity);
+FFI_PLUGIN_EXPORT int zenoh_subscribe_latest(const char* key_expr, size_t capacity);
+FFI_PLUGIN_EXPORT int zenoh_subscriber_drain(int subscriber_id, uint8_t* out_buf, size_t buf_size, int max_samples);
+FFI_PLUGIN_EXPORT int zenoh_declare_queryable(const char* key_expr, int mode, QueryCallback callback, size_t capacity);
+FFI_PLUGIN_EXPORT int zenoh_queryable_drain(int handle, uint8_t* out_buf, size_t buf_size, int max_queries);
+FFI_PLUGIN_EXPORT int zenoh_query_reply(void* query_handle, const uint8_t* payload, size_t len, const char* encoding, const uint8_t* attachment, size_t attachment_len);
+FFI_PLUGIN_EXPORT void zenoh_query_release(void* query_handle);
+FFI_PLUGIN_EXPORT void zenoh_undeclare_queryable(int handle);
 FFI_PLUGIN_EXPORT void zenoh_unsubscribe(int subscriber_id);
 FFI_PLUGIN_EXPORT void zenoh_unsubscribe_all(void);
 